@@ -75,7 +75,6 @@ GameScene::GameScene()
     , mIsPaused(false)
     , mPauseLabel(nullptr)
     , mBlackoutLayer(nullptr)
-    , mContactListener(nullptr)
     , mMouseListener(nullptr)
     , mKeyboardListener(nullptr)
     , mCurrentStage(nullptr)
@@ -88,7 +87,7 @@ GameScene::GameScene()
 
 GameScene::~GameScene()
 {
-
+    _scheduler->releaseTimer(mFireCooldownTimer);
 }
 
 Scene* GameScene::createScene()
@@ -226,6 +225,15 @@ bool GameScene::init()
 
     schedule(CC_SCHEDULE_SELECTOR(GameScene::spawnAsteroid), 1.5f);
 
+    // re-armed on every shot
+    mFireCooldownTimer = _scheduler->createTimer(this, [this](float)
+        {
+            mIsCanShoot = true;
+            if (mIsMousePressed)
+                shootBullet(mMousePosition);
+        }, !isRunning()
+    );
+
     this->scheduleUpdate();
 
     return true;
@@ -273,12 +281,29 @@ void GameScene::createListeners()
         _eventDispatcher->addEventListenerWithSceneGraphPriority(mMouseListener, this);
     }
 
-    mContactListener = EventListenerPhysicsContact::create();
-    if (mContactListener)
+    if (_physicsWorld)
+    {
+        PhysicsContactHandler spaceshipAsteroid;
+        spaceshipAsteroid.onContactBegin = CC_CALLBACK_3(GameScene::onSpaceshipAsteroidContact, this);
+        _physicsWorld->setContactHandler(spaceshipBitMask, asteroidBitMask, spaceshipAsteroid);
+
+        PhysicsContactHandler bulletAsteroid;
+        bulletAsteroid.onContactBegin = CC_CALLBACK_3(GameScene::onBulletAsteroidContact, this);
+        _physicsWorld->setContactHandler(bulletBitMask, asteroidBitMask, bulletAsteroid);
+
+        PhysicsContactHandler bulletBounds;
+        bulletBounds.onContactSeparate = CC_CALLBACK_3(GameScene::onBulletBoundsSeparate, this);
+        _physicsWorld->setContactHandler(bulletBitMask, boundsBitmask, bulletBounds);
+    }
+}
+
+void GameScene::removeContactHandlers()
+{
+    if (_physicsWorld)
     {
-        mContactListener->onContactBegin = CC_CALLBACK_1(GameScene::onContactBegin, this);
-        mContactListener->onContactSeparate = CC_CALLBACK_1(GameScene::onContactSeparate, this);
-        _eventDispatcher->addEventListenerWithSceneGraphPriority(mContactListener, this);
+        _physicsWorld->removeContactHandler(spaceshipBitMask, asteroidBitMask);
+        _physicsWorld->removeContactHandler(bulletBitMask, asteroidBitMask);
+        _physicsWorld->removeContactHandler(bulletBitMask, boundsBitmask);
     }
 }
 
@@ -400,9 +425,8 @@ void GameScene::update(float aDelta)
             continue;
         }
 
-        auto sceneChildren = getChildren();
-        auto findIt = sceneChildren.find(asteroid);
-        if (findIt == sceneChildren.end())
+        // the asteroid may be deleted already, so it is looked up rather than asked for its parent
+        if (!getChildren().contains(asteroid))
         {
             callback();
             it = mDestroyedAsteroidsCallbacks.erase(it);
@@ -658,85 +682,48 @@ void GameScene::splitAsteroid(sAsteroidContactData aAsteroidData, sContactData a
     }
 }
 
-bool GameScene::onContactBegin(PhysicsContact& aContact)
+bool GameScene::onSpaceshipAsteroidContact(PhysicsContact& aContact, PhysicsBody* aSpaceship, PhysicsBody* aAsteroid)
 {
-    auto shapeA = aContact.getShapeA();
-    auto shapeB = aContact.getShapeB();
-    if (!shapeA || !shapeB)
-        return false;
-
-    auto bodyA = shapeA->getBody();
-    auto bodyB = shapeB->getBody();
-    if (!bodyA || !bodyB)
-        return false;
-
-    if ((bodyA->getCategoryBitmask() == asteroidBitMask && bodyB->getCategoryBitmask() == spaceshipBitMask)
-        || (bodyA->getCategoryBitmask() == spaceshipBitMask && bodyB->getCategoryBitmask() == asteroidBitMask))
+    createExplosion(asteroidExpl, aSpaceship->getPosition());
+    if (aSpaceship->getNode())
     {
-        auto spaceship = bodyA->getCategoryBitmask() == spaceshipBitMask ? bodyA : bodyB;
-        if (spaceship)
-        {
-            createExplosion(asteroidExpl, spaceship->getPosition());
-            if (spaceship->getNode())
-            {
-                spaceship->getNode()->removeFromParent();
-                mSpaceship = nullptr;
-            }
-        }
-        gameOver(false);
-    }
-    else if ((bodyA->getCategoryBitmask() == asteroidBitMask && bodyB->getCategoryBitmask() == bulletBitMask)
-        || (bodyA->getCategoryBitmask() == bulletBitMask && bodyB->getCategoryBitmask() == asteroidBitMask))
-    {
-        auto asteroid = bodyA->getCategoryBitmask() == asteroidBitMask ? bodyA : bodyB;
-        auto bullet = bodyA->getCategoryBitmask() == bulletBitMask ? bodyA : bodyB;
-        if (asteroid->getNode() && bullet->getNode())
-        {
-            sAsteroidContactData asteroidData(*asteroid, asteroid->getNode()->getTag());
-            sContactData bulletData(*bullet);
-            mDestroyedAsteroidsCallbacks[bodyA->getNode()] = CC_CALLBACK_0(GameScene::splitAsteroid, this, asteroidData, bulletData);
-            createExplosion(bulletExpl, asteroid->getPosition());
-            asteroid->getNode()->removeFromParent();
-            bullet->getNode()->removeFromParent();
-        }
-        else if (asteroid->getNode())
-        {
-            asteroid->getNode()->removeFromParent();
-        }
-        else if (bullet->getNode())
-        {
-            bullet->getNode()->removeFromParent();
-        }
+        aSpaceship->getNode()->removeFromParent();
+        mSpaceship = nullptr;
     }
+    gameOver(false);
 
     return true;
 }
 
-bool GameScene::onContactSeparate(PhysicsContact& aContact)
+bool GameScene::onBulletAsteroidContact(PhysicsContact& aContact, PhysicsBody* aBullet, PhysicsBody* aAsteroid)
 {
-    auto shapeA = aContact.getShapeA();
-    auto shapeB = aContact.getShapeB();
-
-    auto bodyA = shapeA->getBody();
-    auto bodyB = shapeB->getBody();
-
-    if (!bodyA || !bodyB)
-        return false;
-
-    if (bodyA->getCategoryBitmask() == bulletBitMask && bodyB->getCategoryBitmask() == boundsBitmask)
+    if (aAsteroid->getNode() && aBullet->getNode())
     {
-        if (bodyA->getNode())
-            bodyA->getNode()->removeFromParent();
+        sAsteroidContactData asteroidData(*aAsteroid, aAsteroid->getNode()->getTag());
+        sContactData bulletData(*aBullet);
+        mDestroyedAsteroidsCallbacks[aAsteroid->getNode()] = CC_CALLBACK_0(GameScene::splitAsteroid, this, asteroidData, bulletData);
+        createExplosion(bulletExpl, aAsteroid->getPosition());
+        aAsteroid->getNode()->removeFromParent();
+        aBullet->getNode()->removeFromParent();
     }
-    else if (bodyA->getCategoryBitmask() == boundsBitmask && bodyB->getCategoryBitmask() == bulletBitMask)
+    else if (aAsteroid->getNode())
     {
-        if (bodyB->getNode())
-            bodyB->getNode()->removeFromParent();
+        aAsteroid->getNode()->removeFromParent();
+    }
+    else if (aBullet->getNode())
+    {
+        aBullet->getNode()->removeFromParent();
     }
 
     return true;
 }
 
+void GameScene::onBulletBoundsSeparate(PhysicsContact& aContact, PhysicsBody* aBullet, PhysicsBody* aBounds)
+{
+    if (aBullet->getNode())
+        aBullet->getNode()->removeFromParent();
+}
+
 void GameScene::shootBullet(Vec2 aTarget)
 {
     if (mSpaceship)
@@ -767,13 +754,7 @@ void GameScene::shootBullet(Vec2 aTarget)
             }
             bullet->setRotation(mSpaceship->getRotation());
 
-            this->scheduleOnce([this](float)
-                {
-                    mIsCanShoot = true;
-                    if (mIsMousePressed)
-                        shootBullet(mMousePosition);
-                }, mSpaceshipConfig.bulletCooldown, "fireCooldown"
-            );
+            _scheduler->rearm(mFireCooldownTimer, mSpaceshipConfig.bulletCooldown);
         }
     }
 }
@@ -788,11 +769,7 @@ void GameScene::gameOver(bool aIsWin)
     {
         _physicsWorld->setSpeed(0.0f);
     }
-    if (mContactListener)
-    {
-        _eventDispatcher->removeEventListener(mContactListener);
-        mContactListener = nullptr;
-    }
+    removeContactHandlers();
     if (mMouseListener)
     {
         _eventDispatcher->removeEventListener(mMouseListener);
@@ -832,23 +809,22 @@ void GameScene::switchStage()
 
     if (mCurrentStage)
     {
+        // the unit circle is tessellated and uploaded once, stages only move and scale the node
         auto drawNode = getChildByName<DrawNode*>("stage_circle");
-        if (drawNode)
-        {
-            drawNode->clear();
-        }
-        else
+        if (!drawNode)
         {
             drawNode = DrawNode::create();
             if (drawNode)
             {
                 drawNode->setName("stage_circle");
+                drawNode->drawCircle(Vec2::ZERO, 1.f, 0, 100, false, Color4F::GREEN);
                 this->addChild(drawNode);
             }
         }
         if (drawNode)
         {
-            drawNode->drawCircle(Vec2(mCurrentStage->centerX, mCurrentStage->centerY), mCurrentStage->radius, 0, 100, false, Color4F::GREEN);
+            drawNode->setPosition(mCurrentStage->centerX, mCurrentStage->centerY);
+            drawNode->setScale(mCurrentStage->radius);
         }
     }
 }
@@ -862,8 +838,13 @@ void GameScene::createExplosion(const std::string& aAnimationName, const Vec2& a
         explosion->setPosition(aPosition);
         this->addChild(explosion, 2);
 
-        auto animate = Animate::create(animation);
-        auto remove = RemoveSelf::create();
-        explosion->runAction(Sequence::createWithTwoActions(animate, remove));
+        // explosions of one kind reuse the finished instances of a shared template
+        auto explosionTemplate = mExplosionTemplates.at(aAnimationName);
+        if (!explosionTemplate)
+        {
+            explosionTemplate = ActionTemplate::create(Sequence::createWithTwoActions(Animate::create(animation), RemoveSelf::create()));
+            mExplosionTemplates.insert(aAnimationName, explosionTemplate);
+        }
+        explosion->runAction(explosionTemplate->instantiate());
     }
 }
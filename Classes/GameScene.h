@@ -109,6 +109,8 @@ private:
     sBulletConfig mBulletConfig;
     bool mIsMousePressed;
     bool mIsCanShoot;
+    TimerHandle mFireCooldownTimer;
+    Map<std::string, ActionTemplate*> mExplosionTemplates;
     std::map<float, sAsteroidStageConfig> mAsteroidStages;
     std::unordered_map<Node*, std::function<void()>> mDestroyedAsteroidsCallbacks;
     std::vector<sStageConfig> mStageConfigs;
@@ -119,7 +121,6 @@ private:
 
     EventListenerKeyboard* mKeyboardListener;
     EventListenerMouse* mMouseListener;
-    EventListenerPhysicsContact* mContactListener;
 
     std::chrono::time_point<std::chrono::steady_clock> mGameStartTime;
     std::unique_ptr<sStage> mCurrentStage;
@@ -144,8 +145,10 @@ private:
     void onMouseMove(EventMouse* aEvent);
     void onMouseDown(EventMouse* aEvent);
     void onMouseUp(EventMouse* aEvent);
-    bool onContactBegin(PhysicsContact& aCntact);
-    bool onContactSeparate(PhysicsContact& aContact);
+    bool onSpaceshipAsteroidContact(PhysicsContact& aContact, PhysicsBody* aSpaceship, PhysicsBody* aAsteroid);
+    bool onBulletAsteroidContact(PhysicsContact& aContact, PhysicsBody* aBullet, PhysicsBody* aAsteroid);
+    void onBulletBoundsSeparate(PhysicsContact& aContact, PhysicsBody* aBullet, PhysicsBody* aBounds);
+    void removeContactHandlers();
 
     void shootBullet(Vec2 aTarget);
     void adjustSpaceshipRotation();
@@ -1,6 +1,7 @@
 #include "MainMenuScene.h"
 
 #include "GameScene.h"
+#include "PhysicsBenchmarkScene.h"
 
 MainMenuScene::MainMenuScene()
 {
@@ -32,12 +33,17 @@ bool MainMenuScene::init()
             Director::getInstance()->replaceScene(GameScene::createScene());
         });
 
+    auto benchmarkItem = MenuItemLabel::create(Label::createWithTTF("Physics Benchmark", "fonts/Marker Felt.ttf", 36),
+        [](Ref* sender) {
+            Director::getInstance()->replaceScene(PhysicsBenchmarkScene::createScene());
+        });
+
     auto exitItem = MenuItemLabel::create(Label::createWithTTF("Exit", "fonts/Marker Felt.ttf", 36),
         [](Ref* sender) {
             Director::getInstance()->end();
         });
 
-    auto menu = Menu::create(startItem, exitItem, nullptr);
+    auto menu = Menu::create(startItem, benchmarkItem, exitItem, nullptr);
     menu->alignItemsVerticallyWithPadding(20.0f);
     menu->setPosition(Vec2(origin.x + visibleSize.width / 2, origin.y + visibleSize.height / 2));
     this->addChild(menu);
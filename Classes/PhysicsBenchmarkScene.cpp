@@ -0,0 +1,230 @@
+#include "PhysicsBenchmarkScene.h"
+
+#include "MainMenuScene.h"
+#include <chrono>
+#include <random>
+
+const float benchmarkBodyRadius = 6.f;
+const float benchmarkStep = 1.f / 60.f;
+const int benchmarkWarmupFrames = 30;
+const int benchmarkMeasuredFrames = 120;
+
+const std::vector<PhysicsBenchmarkScene::sWorldConfig> PhysicsBenchmarkScene::sWorldConfigs =
+{
+    { "bbtree, 1 thread", 1, 10, false, false },
+    { "bbtree, 2 threads", 2, 10, false, false },
+    { "spatial hash, 2 threads", 2, 10, true, false },
+    { "spatial hash, 2 threads, sleeping, 5 iterations", 2, 5, true, true },
+};
+
+const std::vector<int> PhysicsBenchmarkScene::sBodyCounts = { 250, 500, 1000 };
+
+std::vector<PhysicsBenchmarkScene::sResult> PhysicsBenchmarkScene::sResults;
+
+PhysicsBenchmarkScene::PhysicsBenchmarkScene(size_t aRun)
+    : mRun(aRun)
+    , mConfig(&sWorldConfigs[aRun / sBodyCounts.size()])
+    , mBodyCount(sBodyCounts[aRun % sBodyCounts.size()])
+    , mThreadsSupported(true)
+    , mFrame(0)
+    , mStepTimeSum(0.0)
+    , mStatusLabel(nullptr)
+{
+
+}
+
+PhysicsBenchmarkScene::~PhysicsBenchmarkScene()
+{
+
+}
+
+Scene* PhysicsBenchmarkScene::createScene(size_t aRun)
+{
+    if (aRun == 0)
+    {
+        sResults.clear();
+    }
+
+    Scene* ret = new (std::nothrow) PhysicsBenchmarkScene(aRun);
+    if (ret && ret->initWithPhysics() && ret->init())
+    {
+        ret->autorelease();
+        return ret;
+    }
+    else
+    {
+        CC_SAFE_DELETE(ret);
+        return nullptr;
+    }
+}
+
+bool PhysicsBenchmarkScene::init()
+{
+    if (!_physicsWorld)
+    {
+        return false;
+    }
+
+    applyConfig();
+    createScreenBounds();
+    createBodies();
+
+    auto visibleSize = Director::getInstance()->getVisibleSize();
+    Vec2 origin = Director::getInstance()->getVisibleOrigin();
+
+    mStatusLabel = Label::createWithTTF(StringUtils::format("Run %d/%d: %s%s, %d bodies",
+        static_cast<int>(mRun + 1), static_cast<int>(sWorldConfigs.size() * sBodyCounts.size()), mConfig->name,
+        mThreadsSupported ? "" : " (threads unsupported)", mBodyCount),
+        "fonts/Marker Felt.ttf", 24);
+    if (mStatusLabel)
+    {
+        mStatusLabel->setPosition(Vec2(origin.x + visibleSize.width / 2,
+            origin.y + visibleSize.height - mStatusLabel->getContentSize().height));
+        this->addChild(mStatusLabel, 1);
+    }
+
+    this->scheduleUpdate();
+
+    return true;
+}
+
+void PhysicsBenchmarkScene::applyConfig()
+{
+    // steps are driven from update() so only PhysicsWorld::step() is timed,
+    // that is the solver plus syncing the bodies with their nodes and dispatching contacts
+    _physicsWorld->setAutoStep(false);
+    _physicsWorld->setGravity(Vec2(0, -300.f));
+    _physicsWorld->setThreads(mConfig->threads);
+    // some platforms always step on one thread
+    mThreadsSupported = _physicsWorld->getThreads() == mConfig->threads;
+    _physicsWorld->setIterations(mConfig->iterations);
+    if (mConfig->spatialHash)
+    {
+        _physicsWorld->useSpatialHash(benchmarkBodyRadius * 2, mBodyCount * 10);
+    }
+    if (mConfig->sleeping)
+    {
+        _physicsWorld->setSleepTimeThreshold(0.5f);
+    }
+}
+
+void PhysicsBenchmarkScene::createScreenBounds()
+{
+    auto visibleSize = Director::getInstance()->getVisibleSize();
+    auto origin = Director::getInstance()->getVisibleOrigin();
+
+    auto edgeNode = Node::create();
+    if (edgeNode)
+    {
+        edgeNode->setPosition(visibleSize.width / 2 + origin.x, visibleSize.height / 2 + origin.y);
+        auto edgeBody = PhysicsBody::createEdgeBox(visibleSize);
+        if (edgeBody)
+        {
+            edgeBody->setDynamic(false);
+            edgeNode->setPhysicsBody(edgeBody);
+        }
+        this->addChild(edgeNode);
+    }
+}
+
+void PhysicsBenchmarkScene::createBodies()
+{
+    auto visibleSize = Director::getInstance()->getVisibleSize();
+    auto origin = Director::getInstance()->getVisibleOrigin();
+
+    // the same layout for every run
+    std::mt19937 engine(12345);
+    std::uniform_real_distribution<float> x(origin.x + benchmarkBodyRadius, origin.x + visibleSize.width - benchmarkBodyRadius);
+    std::uniform_real_distribution<float> y(origin.y + benchmarkBodyRadius, origin.y + visibleSize.height - benchmarkBodyRadius);
+    std::uniform_real_distribution<float> speed(-100.f, 100.f);
+
+    for (int i = 0; i < mBodyCount; ++i)
+    {
+        auto node = Sprite::create("asteroid.png");
+        if (!node)
+            continue;
+
+        node->setScale(benchmarkBodyRadius * 2 / node->getContentSize().width);
+        node->setPosition(x(engine), y(engine));
+        this->addChild(node);
+
+        // the body is scaled with the sprite
+        auto body = PhysicsBody::createCircle(node->getContentSize().width / 2, PhysicsMaterial(1.f, 0.3f, 0.5f));
+        if (body)
+        {
+            body->setVelocity(Vec2(speed(engine), speed(engine)));
+            node->setPhysicsBody(body);
+        }
+    }
+}
+
+void PhysicsBenchmarkScene::update(float aDelta)
+{
+    const auto start = std::chrono::steady_clock::now();
+    _physicsWorld->step(benchmarkStep);
+    const auto end = std::chrono::steady_clock::now();
+
+    if (++mFrame <= benchmarkWarmupFrames)
+        return;
+
+    mStepTimeSum += std::chrono::duration<double, std::milli>(end - start).count();
+    if (mFrame < benchmarkWarmupFrames + benchmarkMeasuredFrames)
+        return;
+
+    sResult result = { mConfig, mThreadsSupported, mBodyCount, static_cast<float>(mStepTimeSum / benchmarkMeasuredFrames) };
+    sResults.push_back(result);
+    CCLOG("Physics benchmark: %s%s, %d bodies: %.3f ms/step", mConfig->name,
+        mThreadsSupported ? "" : " (threads unsupported)", mBodyCount, result.stepTime);
+
+    this->unscheduleUpdate();
+    if (mRun + 1 < sWorldConfigs.size() * sBodyCounts.size())
+    {
+        Director::getInstance()->replaceScene(PhysicsBenchmarkScene::createScene(mRun + 1));
+    }
+    else
+    {
+        showResults();
+    }
+}
+
+void PhysicsBenchmarkScene::showResults()
+{
+    for (auto child : getChildren())
+    {
+        if (child != mStatusLabel && child->getPhysicsBody())
+        {
+            child->setVisible(false);
+        }
+    }
+
+    std::string text;
+    for (const auto& result : sResults)
+    {
+        text += StringUtils::format("%s%s, %d bodies: %.3f ms/step\n", result.config->name,
+            result.threadsSupported ? "" : " (threads unsupported)", result.bodyCount, result.stepTime);
+    }
+
+    auto visibleSize = Director::getInstance()->getVisibleSize();
+    Vec2 origin = Director::getInstance()->getVisibleOrigin();
+
+    if (mStatusLabel)
+    {
+        mStatusLabel->setString("Physics Benchmark");
+    }
+
+    auto resultsLabel = Label::createWithTTF(text, "fonts/Marker Felt.ttf", 16);
+    if (resultsLabel)
+    {
+        resultsLabel->setPosition(Vec2(origin.x + visibleSize.width / 2, origin.y + visibleSize.height / 2));
+        this->addChild(resultsLabel, 1);
+    }
+
+    auto backItem = MenuItemLabel::create(Label::createWithTTF("Back", "fonts/Marker Felt.ttf", 36),
+        [](Ref* sender) {
+            Director::getInstance()->replaceScene(MainMenuScene::create());
+        });
+
+    auto menu = Menu::create(backItem, nullptr);
+    menu->setPosition(Vec2(origin.x + visibleSize.width / 2, origin.y + backItem->getContentSize().height));
+    this->addChild(menu, 1);
+}
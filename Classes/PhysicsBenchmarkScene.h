@@ -0,0 +1,59 @@
+#ifndef __PHYSICS_BENCHMARK_SCENE_H__
+#define __PHYSICS_BENCHMARK_SCENE_H__
+
+#include "cocos2d.h"
+
+USING_NS_CC;
+
+// Steps a pile of circles under every world configuration and body count, one scene per run,
+// and shows the average step time of each run when the sweep is over.
+class PhysicsBenchmarkScene
+    : public Scene
+{
+private:
+    struct sWorldConfig
+    {
+        const char* name;
+        int threads;
+        int iterations;
+        bool spatialHash;
+        bool sleeping;
+    };
+
+    struct sResult
+    {
+        const sWorldConfig* config;
+        bool threadsSupported;
+        int bodyCount;
+        float stepTime;
+    };
+
+private:
+    static const std::vector<sWorldConfig> sWorldConfigs;
+    static const std::vector<int> sBodyCounts;
+    static std::vector<sResult> sResults;
+
+    size_t mRun;
+    const sWorldConfig* mConfig;
+    int mBodyCount;
+    bool mThreadsSupported;
+    int mFrame;
+    double mStepTimeSum;
+    Label* mStatusLabel;
+
+private:
+    bool init() override;
+    void applyConfig();
+    void createScreenBounds();
+    void createBodies();
+    void update(float aDelta) override;
+    void showResults();
+
+public:
+    PhysicsBenchmarkScene(size_t aRun);
+    virtual ~PhysicsBenchmarkScene();
+
+    static Scene* createScene(size_t aRun = 0);
+};
+
+#endif // __PHYSICS_BENCHMARK_SCENE_H__
@@ -42,6 +42,9 @@ Action::Action()
 ,_target(nullptr)
 ,_tag(Action::INVALID_TAG)
 ,_flags(0)
+,_batchType(-1)
+,_batchIndex(-1)
+,_template(nullptr)
 {
 #if CC_ENABLE_SCRIPT_BINDING
     ScriptEngineProtocol* engine = ScriptEngineManager::getInstance()->getScriptEngine();
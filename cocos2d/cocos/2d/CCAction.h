@@ -36,6 +36,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class Node;
+class ActionTemplate;
 
 enum {
     kActionUpdate
@@ -178,6 +179,14 @@ protected:
     int     _tag;
     /** The action flag field. To categorize action into certain groups.*/
     unsigned int _flags;
+    /** The batch of the ActionManager that steps the action, and the slot in it. -1 when the action is stepped on its own. */
+    int _batchType;
+    int _batchIndex;
+    /** The template the action is an instance of, nullptr if it wasn't instantiated from one. */
+    ActionTemplate *_template;
+
+    friend class ActionManager;
+    friend class ActionTemplate;
 
 #if CC_ENABLE_SCRIPT_BINDING
     ccScriptType _scriptType;         ///< type of script binding, lua or javascript
@@ -117,6 +117,8 @@ protected:
     float _elapsed;
     bool _firstTick;
     bool _done;
+
+    friend class ActionManager;
     
 protected:
     bool sendUpdateEventToScript(float dt, Action *actionObject);
@@ -508,6 +510,8 @@ protected:
     Vec3 _startAngle;
     Vec3 _diffAngle;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(RotateTo);
 };
@@ -574,6 +578,8 @@ protected:
     Vec3 _deltaAngle;
     Vec3 _startAngle;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(RotateBy);
 };
@@ -630,6 +636,8 @@ protected:
     Vec3 _startPosition;
     Vec3 _previousPosition;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(MoveBy);
 };
@@ -1125,6 +1133,8 @@ protected:
     float _deltaY;
     float _deltaZ;
 
+    friend class ActionManager;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(ScaleTo);
 };
@@ -1264,6 +1274,7 @@ protected:
     GLubyte _fromOpacity;
     friend class FadeOut;
     friend class FadeIn;
+    friend class ActionManager;
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(FadeTo);
 };
@@ -30,10 +30,18 @@ THE SOFTWARE.
 #include "2d/CCActionManager.h"
 #include "2d/CCNode.h"
 #include "2d/CCAction.h"
+#include "2d/CCActionInterval.h"
+#include "2d/CCActionTemplate.h"
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
 #include "base/ccCArray.h"
 #include "base/uthash.h"
+#if CC_ENABLE_SCRIPT_BINDING
+#include "base/CCScriptSupport.h"
+#endif
+
+#include <algorithm>
+#include <typeinfo>
 
 NS_CC_BEGIN
 //
@@ -50,10 +58,119 @@ typedef struct _hashElement
     UT_hash_handle      hh;
 } tHashElement;
 
+//
+// batches
+//
+
+// The action types stepped by updateBatches() instead of Action::step()
+enum
+{
+    BATCH_MOVE,
+    BATCH_ROTATE,
+    BATCH_SCALE,
+    BATCH_FADE,
+    BATCH_COUNT
+};
+
+// The batched actions of one type, one column per field
+struct ActionManager::ActionBatch
+{
+    std::vector<ActionInterval*> actions; // nullptr once removed while the batches are locked
+    std::vector<Node*> targets;
+    std::vector<float> elapsed;
+    std::vector<float> durations;
+    std::vector<float> times;
+    std::vector<unsigned char> firstTicks;
+    std::vector<unsigned char> paused;
+    std::vector<unsigned char> is3D;
+    std::vector<Vec3> starts;
+    std::vector<Vec3> deltas;
+    std::vector<Vec3> previous;
+    bool hasHoles;
+
+    ActionBatch()
+    : hasHoles(false)
+    {
+    }
+
+    void removeAt(size_t index)
+    {
+        const size_t last = actions.size() - 1;
+        if (index != last)
+        {
+            actions[index] = actions[last];
+            targets[index] = targets[last];
+            elapsed[index] = elapsed[last];
+            durations[index] = durations[last];
+            times[index] = times[last];
+            firstTicks[index] = firstTicks[last];
+            paused[index] = paused[last];
+            is3D[index] = is3D[last];
+            starts[index] = starts[last];
+            deltas[index] = deltas[last];
+            previous[index] = previous[last];
+            if (actions[index])
+            {
+                actions[index]->_batchIndex = static_cast<int>(index);
+            }
+        }
+
+        actions.pop_back();
+        targets.pop_back();
+        elapsed.pop_back();
+        durations.pop_back();
+        times.pop_back();
+        firstTicks.pop_back();
+        paused.pop_back();
+        is3D.pop_back();
+        starts.pop_back();
+        deltas.pop_back();
+        previous.pop_back();
+    }
+
+    void compact()
+    {
+        // from the back, so that the slot moved into a hole is never a hole itself
+        for (size_t i = actions.size(); i > 0; --i)
+        {
+            if (actions[i - 1] == nullptr)
+            {
+                removeAt(i - 1);
+            }
+        }
+        hasHoles = false;
+    }
+};
+
+// Only the exact types, subclasses may override update()
+static int getBatchType(const Action *action)
+{
+    const std::type_info& type = typeid(*action);
+    if (type == typeid(MoveBy) || type == typeid(MoveTo))
+    {
+        return BATCH_MOVE;
+    }
+    if (type == typeid(RotateBy) || type == typeid(RotateTo))
+    {
+        return BATCH_ROTATE;
+    }
+    if (type == typeid(ScaleTo) || type == typeid(ScaleBy))
+    {
+        return BATCH_SCALE;
+    }
+    if (type == typeid(FadeTo) || type == typeid(FadeIn) || type == typeid(FadeOut))
+    {
+        return BATCH_FADE;
+    }
+    return -1;
+}
+
 ActionManager::ActionManager()
 : _targets(nullptr),
   _currentTarget(nullptr),
-  _currentTargetSalvaged(false)
+  _currentTargetSalvaged(false),
+  _batches(new ActionBatch[BATCH_COUNT]),
+  _batchesLocked(false)
 {
 
 }
@@ -63,12 +180,269 @@ ActionManager::~ActionManager()
     CCLOGINFO("deallocing ActionManager: %p", this);
 
     removeAllActions();
+    delete [] _batches;
+}
+
+void ActionManager::batchAction(Action *action, tHashElement *element)
+{
+    const int type = getBatchType(action);
+    if (type < 0)
+    {
+        return;
+    }
+#if CC_ENABLE_SCRIPT_BINDING
+    // script actions get their update events from ActionInterval::step()
+    if (action->_scriptType != kScriptTypeNone)
+    {
+        return;
+    }
+#endif
+
+    ActionInterval *interval = static_cast<ActionInterval*>(action);
+    Vec3 start;
+    Vec3 delta;
+    Vec3 previous;
+    bool is3D = false;
+    switch (type)
+    {
+        case BATCH_MOVE:
+        {
+            MoveBy *move = static_cast<MoveBy*>(action);
+            start = move->_startPosition;
+            delta = move->_positionDelta;
+            previous = move->_previousPosition;
+            break;
+        }
+        case BATCH_ROTATE:
+            if (typeid(*action) == typeid(RotateTo))
+            {
+                RotateTo *rotate = static_cast<RotateTo*>(action);
+                start = rotate->_startAngle;
+                delta = rotate->_diffAngle;
+                is3D = rotate->_is3D;
+            }
+            else
+            {
+                RotateBy *rotate = static_cast<RotateBy*>(action);
+                start = rotate->_startAngle;
+                delta = rotate->_deltaAngle;
+                is3D = rotate->_is3D;
+            }
+            break;
+        case BATCH_SCALE:
+        {
+            ScaleTo *scale = static_cast<ScaleTo*>(action);
+            start.set(scale->_startScaleX, scale->_startScaleY, scale->_startScaleZ);
+            delta.set(scale->_deltaX, scale->_deltaY, scale->_deltaZ);
+            break;
+        }
+        case BATCH_FADE:
+        {
+            FadeTo *fade = static_cast<FadeTo*>(action);
+            start.x = fade->_fromOpacity;
+            delta.x = static_cast<float>(fade->_toOpacity - fade->_fromOpacity);
+            break;
+        }
+    }
+
+    ActionBatch& batch = _batches[type];
+    action->_batchType = type;
+    action->_batchIndex = static_cast<int>(batch.actions.size());
+    batch.actions.push_back(interval);
+    batch.targets.push_back(action->getTarget());
+    batch.elapsed.push_back(interval->_elapsed);
+    batch.durations.push_back(interval->getDuration());
+    batch.times.push_back(0.0f);
+    batch.firstTicks.push_back(interval->_firstTick);
+    batch.paused.push_back(element->paused);
+    batch.is3D.push_back(is3D);
+    batch.starts.push_back(start);
+    batch.deltas.push_back(delta);
+    batch.previous.push_back(previous);
+}
+
+void ActionManager::unbatchAction(Action *action)
+{
+    if (action->_batchIndex < 0)
+    {
+        return;
+    }
+
+    ActionBatch& batch = _batches[action->_batchType];
+    const size_t index = action->_batchIndex;
+    action->_batchType = -1;
+    action->_batchIndex = -1;
+
+    if (_batchesLocked)
+    {
+        batch.actions[index] = nullptr;
+        batch.hasHoles = true;
+    }
+    else
+    {
+        batch.removeAt(index);
+    }
+}
+
+void ActionManager::retireAction(Action *action)
+{
+    unbatchAction(action);
+    // it is free once the reference of the actions array is released
+    if (action->_template)
+    {
+        action->_template->recycle(action);
+    }
+}
+
+void ActionManager::setBatchPaused(tHashElement *element, bool paused)
+{
+    for (int i = 0; i < element->actions->num; ++i)
+    {
+        Action *action = static_cast<Action*>(element->actions->arr[i]);
+        if (action->_batchIndex >= 0)
+        {
+            _batches[action->_batchType].paused[action->_batchIndex] = paused;
+        }
+    }
+}
+
+void ActionManager::updateBatches(float dt)
+{
+    _batchesLocked = true;
+
+    for (int type = 0; type < BATCH_COUNT; ++type)
+    {
+        ActionBatch& batch = _batches[type];
+        const size_t count = batch.actions.size();
+        if (count == 0)
+        {
+            continue;
+        }
+
+        // ActionInterval::step() for the whole batch, paused actions keep their state
+        float *elapsed = batch.elapsed.data();
+        const float *durations = batch.durations.data();
+        float *times = batch.times.data();
+        unsigned char *firstTicks = batch.firstTicks.data();
+        const unsigned char *paused = batch.paused.data();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const float stepped = firstTicks[i] ? MATH_EPSILON : elapsed[i] + dt;
+            elapsed[i] = paused[i] ? elapsed[i] : stepped;
+            firstTicks[i] = firstTicks[i] & paused[i];
+            // needed for rewind. elapsed could be negative
+            times[i] = std::max(0.0f, std::min(1.0f, elapsed[i] / durations[i]));
+        }
+
+        // The update() of each type, written to the nodes in one pass. Node setters may add actions
+        // and grow the columns, so they are indexed again after every call.
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (batch.paused[i] || batch.actions[i] == nullptr)
+            {
+                continue;
+            }
+
+            Node *target = batch.targets[i];
+            const Vec3 start = batch.starts[i];
+            const Vec3 delta = batch.deltas[i];
+            const float time = batch.times[i];
+            switch (type)
+            {
+                case BATCH_MOVE:
+                {
+#if CC_ENABLE_STACKABLE_ACTIONS
+                    const Vec3 startPosition = start + target->getPosition3D() - batch.previous[i];
+                    const Vec3 newPos = startPosition + delta * time;
+                    batch.starts[i] = startPosition;
+                    batch.previous[i] = newPos;
+                    target->setPosition3D(newPos);
+#else
+                    target->setPosition3D(start + delta * time);
+#endif // CC_ENABLE_STACKABLE_ACTIONS
+                    break;
+                }
+                case BATCH_ROTATE:
+                    if (batch.is3D[i])
+                    {
+                        target->setRotation3D(start + delta * time);
+                    }
+                    else
+                    {
+#if CC_USE_PHYSICS
+                        if (start.x == start.y && delta.x == delta.y)
+                        {
+                            target->setRotation(start.x + delta.x * time);
+                        }
+                        else
+                        {
+                            target->setRotationSkewX(start.x + delta.x * time);
+                            target->setRotationSkewY(start.y + delta.y * time);
+                        }
+#else
+                        target->setRotationSkewX(start.x + delta.x * time);
+                        target->setRotationSkewY(start.y + delta.y * time);
+#endif // CC_USE_PHYSICS
+                    }
+                    break;
+                case BATCH_SCALE:
+                    target->setScaleX(start.x + delta.x * time);
+                    target->setScaleY(start.y + delta.y * time);
+                    target->setScaleZ(start.z + delta.z * time);
+                    break;
+                case BATCH_FADE:
+                    target->setOpacity((GLubyte)(start.x + delta.x * time));
+                    break;
+            }
+
+            // the node may have removed the action
+            ActionInterval *action = batch.actions[i];
+            if (action == nullptr)
+            {
+                continue;
+            }
+            action->_firstTick = false;
+            action->_elapsed = batch.elapsed[i];
+            action->_done = batch.elapsed[i] >= batch.durations[i];
+            if (action->_done)
+            {
+                action->retain();
+                _finishedBatchActions.push_back(action);
+            }
+        }
+    }
+
+    _batchesLocked = false;
+    for (int type = 0; type < BATCH_COUNT; ++type)
+    {
+        if (_batches[type].hasHoles)
+        {
+            _batches[type].compact();
+        }
+    }
+
+    for (size_t i = 0; i < _finishedBatchActions.size(); ++i)
+    {
+        Action *action = _finishedBatchActions[i];
+        // unless an earlier one removed it already
+        if (action->_batchIndex >= 0)
+        {
+            action->stop();
+            removeAction(action);
+        }
+        action->release();
+    }
+    _finishedBatchActions.clear();
 }
 
 // private
 
 void ActionManager::deleteHashElement(tHashElement *element)
 {
+    for (int i = 0; i < element->actions->num; ++i)
+    {
+        retireAction(static_cast<Action*>(element->actions->arr[i]));
+    }
     ccArrayFree(element->actions);
     HASH_DEL(_targets, element);
     element->target->release();
@@ -99,6 +473,7 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
         element->currentActionSalvaged = true;
     }
 
+    retireAction(action);
     ccArrayRemoveObjectAtIndex(element->actions, index, true);
 
     // update actionIndex in case we are in tick. looping over the actions
@@ -129,6 +504,7 @@ void ActionManager::pauseTarget(Node *target)
     if (element)
     {
         element->paused = true;
+        setBatchPaused(element, true);
     }
 }
 
@@ -139,6 +515,7 @@ void ActionManager::resumeTarget(Node *target)
     if (element)
     {
         element->paused = false;
+        setBatchPaused(element, false);
     }
 }
 
@@ -151,6 +528,7 @@ Vector<Node*> ActionManager::pauseAllRunningActions()
         if (! element->paused) 
         {
             element->paused = true;
+            setBatchPaused(element, true);
             idsWithActions.pushBack(element->target);
         }
     }    
@@ -194,6 +572,7 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
      ccArrayAppendObject(element->actions, action);
  
      action->startWithTarget(target);
+     batchAction(action, element);
 }
 
 // remove
@@ -226,6 +605,10 @@ void ActionManager::removeAllActionsFromTarget(Node *target)
             element->currentActionSalvaged = true;
         }
 
+        for (int i = 0; i < element->actions->num; ++i)
+        {
+            retireAction(static_cast<Action*>(element->actions->arr[i]));
+        }
         ccArrayRemoveAllObjects(element->actions);
         if (_currentTarget == element)
         {
@@ -439,6 +822,8 @@ ssize_t ActionManager::getNumberOfRunningActions() const
 // main loop
 void ActionManager::update(float dt)
 {
+    updateBatches(dt);
+
     for (tHashElement *elt = _targets; elt != nullptr; )
     {
         _currentTarget = elt;
@@ -450,11 +835,13 @@ void ActionManager::update(float dt)
             for (_currentTarget->actionIndex = 0; _currentTarget->actionIndex < _currentTarget->actions->num;
                 _currentTarget->actionIndex++)
             {
-                _currentTarget->currentAction = static_cast<Action*>(_currentTarget->actions->arr[_currentTarget->actionIndex]);
-                if (_currentTarget->currentAction == nullptr)
+                Action *action = static_cast<Action*>(_currentTarget->actions->arr[_currentTarget->actionIndex]);
+                // batched actions were stepped by updateBatches()
+                if (action == nullptr || action->_batchIndex >= 0)
                 {
                     continue;
                 }
+                _currentTarget->currentAction = action;
 
                 _currentTarget->currentActionSalvaged = false;
 
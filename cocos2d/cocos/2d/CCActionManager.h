@@ -206,10 +206,25 @@ protected:
     void deleteHashElement(struct _hashElement *element);
     void actionAllocWithHashElement(struct _hashElement *element);
 
+    // The common interval actions are stepped together, one batch per action type, defined in the .cpp file.
+    struct ActionBatch;
+
+    void batchAction(Action *action, struct _hashElement *element);
+    void unbatchAction(Action *action);
+    // Unbatches an action being removed and hands it back to the ActionTemplate it came from.
+    void retireAction(Action *action);
+    void setBatchPaused(struct _hashElement *element, bool paused);
+    void updateBatches(float dt);
+
 protected:
     struct _hashElement    *_targets;
     struct _hashElement    *_currentTarget;
     bool            _currentTargetSalvaged;
+
+    ActionBatch            *_batches;
+    std::vector<Action*>    _finishedBatchActions;
+    // If true unbatchAction() only clears the slot, the batches are compacted after the update.
+    bool            _batchesLocked;
 };
 
 // end of actions group
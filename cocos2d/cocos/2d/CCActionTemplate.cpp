@@ -0,0 +1,120 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "2d/CCActionTemplate.h"
+#include "2d/CCAction.h"
+
+#include <algorithm>
+
+NS_CC_BEGIN
+
+ActionTemplate* ActionTemplate::create(FiniteTimeAction *prototype)
+{
+    ActionTemplate *ret = new (std::nothrow) ActionTemplate();
+    if (ret && ret->initWithPrototype(prototype))
+    {
+        ret->autorelease();
+        return ret;
+    }
+
+    delete ret;
+    return nullptr;
+}
+
+ActionTemplate::ActionTemplate()
+: _prototype(nullptr)
+{
+}
+
+ActionTemplate::~ActionTemplate()
+{
+    for (auto action : _instances)
+    {
+        // the running ones are deleted by ActionManager once they are removed
+        action->_template = nullptr;
+        action->release();
+    }
+    CC_SAFE_RELEASE(_prototype);
+}
+
+bool ActionTemplate::initWithPrototype(FiniteTimeAction *prototype)
+{
+    if (prototype == nullptr)
+    {
+        log("ActionTemplate::initWithPrototype error: prototype should not be null!");
+        return false;
+    }
+
+    _prototype = prototype->clone();
+    _prototype->retain();
+    return true;
+}
+
+FiniteTimeAction* ActionTemplate::instantiate()
+{
+    // an instance handed back while someone else still holds it stays in the list until it is released
+    for (size_t i = _freeInstances.size(); i > 0; --i)
+    {
+        FiniteTimeAction *action = _freeInstances[i - 1];
+        if (action->getReferenceCount() == 1)
+        {
+            _freeInstances[i - 1] = _freeInstances.back();
+            _freeInstances.pop_back();
+            return action;
+        }
+    }
+
+    return cloneInstance();
+}
+
+void ActionTemplate::reserve(size_t count)
+{
+    while (_freeInstances.size() < count)
+    {
+        _freeInstances.push_back(cloneInstance());
+    }
+}
+
+FiniteTimeAction* ActionTemplate::cloneInstance()
+{
+    // the clone is autoreleased, the template keeps its own reference
+    FiniteTimeAction *action = _prototype->clone();
+    action->retain();
+    action->_template = this;
+    _instances.push_back(action);
+    return action;
+}
+
+void ActionTemplate::recycle(Action *action)
+{
+    auto instance = static_cast<FiniteTimeAction*>(action);
+    // an instance the user ran again by hand may come back while it is still in the list
+    if (std::find(_freeInstances.begin(), _freeInstances.end(), instance) == _freeInstances.end())
+    {
+        _freeInstances.push_back(instance);
+    }
+}
+
+NS_CC_END
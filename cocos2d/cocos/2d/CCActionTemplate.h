@@ -0,0 +1,109 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __ACTION_CCACTION_TEMPLATE_H__
+#define __ACTION_CCACTION_TEMPLATE_H__
+
+#include "base/CCRef.h"
+#include <vector>
+
+NS_CC_BEGIN
+
+class Action;
+class FiniteTimeAction;
+
+/**
+ * @addtogroup actions
+ * @{
+ */
+
+/** @class ActionTemplate
+ * @brief An immutable description of an action, and the pool of its instances.
+ *
+ * The template keeps a private clone of the prototype it is created with, so it can be shared by
+ * any number of nodes and scenes. Instances are clones of that prototype; when ActionManager removes
+ * a finished or stopped instance, the instance goes back to the free list of its template instead of
+ * being deleted, and the next instantiate() runs it again without allocating.
+ * An ActionTemplate can only be used from the cocos thread.
+ * @js NA
+ */
+class CC_DLL ActionTemplate : public Ref
+{
+public:
+    /** Creates a template of an action.
+     *
+     * @param prototype The action that is cloned for every instance. It is cloned once more here,
+     *                  changing or running it afterwards doesn't change the template.
+     * @return An autoreleased ActionTemplate object.
+     */
+    static ActionTemplate* create(FiniteTimeAction *prototype);
+
+    /** Returns a free instance of the template, cloning the prototype only if there is none.
+     * The instance is owned by the template and is not autoreleased: run it right away or retain it.
+     *
+     * @return An instance that is not running.
+     */
+    FiniteTimeAction* instantiate();
+
+    /** Clones instances ahead, so that the first instantiations don't allocate either.
+     *
+     * @param count The number of free instances to have.
+     */
+    void reserve(size_t count);
+
+    /** Returns the number of instances owned by the template, running or free. */
+    size_t getInstanceCount() const { return _instances.size(); }
+
+    /** Returns the number of instances that were handed back. */
+    size_t getFreeCount() const { return _freeInstances.size(); }
+
+CC_CONSTRUCTOR_ACCESS:
+    ActionTemplate();
+    virtual ~ActionTemplate();
+
+    bool initWithPrototype(FiniteTimeAction *prototype);
+
+protected:
+    /** Called by ActionManager when it removes an instance of the template. */
+    void recycle(Action *action);
+
+    FiniteTimeAction* cloneInstance();
+
+    FiniteTimeAction *_prototype;
+    std::vector<FiniteTimeAction*> _instances;
+    std::vector<FiniteTimeAction*> _freeInstances;
+
+    friend class ActionManager;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(ActionTemplate);
+};
+
+// end of actions group
+/// @}
+
+NS_CC_END
+
+#endif // __ACTION_CCACTION_TEMPLATE_H__
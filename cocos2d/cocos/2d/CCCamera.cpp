@@ -281,6 +281,43 @@ Vec2 Camera::projectGL(const Vec3& src) const
     return screenPos;
 }
 
+bool Camera::projectRectGL(const Mat4& transform, const Rect& rect, Rect* screenRect) const
+{
+    Vec3 corners[4] = {
+        Vec3(rect.getMinX(), rect.getMinY(), 0.0f),
+        Vec3(rect.getMaxX(), rect.getMinY(), 0.0f),
+        Vec3(rect.getMaxX(), rect.getMaxY(), 0.0f),
+        Vec3(rect.getMinX(), rect.getMaxY(), 0.0f)
+    };
+    Vec2 projected[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        transform.transformPoint(&corners[i]);
+        Vec4 clipPos;
+        getViewProjectionMatrix().transformVector(Vec4(corners[i].x, corners[i].y, corners[i].z, 1.0f), &clipPos);
+        if (clipPos.w <= 0.0f)
+            return false;
+        projected[i] = projectGL(corners[i]);
+    }
+
+    // edges 0-1 and 2-3 must stay horizontal and edges 1-2 and 3-0 vertical, or the other way round
+    // when the node is rotated by a multiple of 90 degrees
+    static const float tolerance = 0.01f;
+    bool straight = fabsf(projected[0].y - projected[1].y) < tolerance && fabsf(projected[2].y - projected[3].y) < tolerance
+                 && fabsf(projected[1].x - projected[2].x) < tolerance && fabsf(projected[3].x - projected[0].x) < tolerance;
+    bool turned = fabsf(projected[0].x - projected[1].x) < tolerance && fabsf(projected[2].x - projected[3].x) < tolerance
+               && fabsf(projected[1].y - projected[2].y) < tolerance && fabsf(projected[3].y - projected[0].y) < tolerance;
+    if (!straight && !turned)
+        return false;
+
+    float minX = std::min(projected[0].x, projected[2].x);
+    float maxX = std::max(projected[0].x, projected[2].x);
+    float minY = std::min(projected[0].y, projected[2].y);
+    float maxY = std::max(projected[0].y, projected[2].y);
+    screenRect->setRect(minX, minY, maxX - minX, maxY - minY);
+    return true;
+}
+
 Vec3 Camera::unproject(const Vec3& src) const
 {
     Vec3 dst;
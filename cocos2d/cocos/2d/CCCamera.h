@@ -163,6 +163,16 @@ public:
      * @return The GL-screen-space position.
      */
     Vec2 projectGL(const Vec3& src) const;
+
+    /**
+     * Projects a rectangle given in a node's local space into GL-screen-space.
+     *
+     * @param transform The node-to-world transform of the rectangle.
+     * @param rect The rectangle in local space.
+     * @param screenRect Filled with the projected rectangle on success.
+     * @return false if the projected rectangle is not axis-aligned on screen (rotation, skew or perspective).
+     */
+    bool projectRectGL(const Mat4& transform, const Rect& rect, Rect* screenRect) const;
     
     /**
      * Convert the specified point of screen-space coordinate into the 3D world-space coordinate.
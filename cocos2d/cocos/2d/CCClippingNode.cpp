@@ -28,6 +28,8 @@
 
 #include "2d/CCClippingNode.h"
 #include "2d/CCDrawingPrimitives.h"
+#include "2d/CCLayer.h"
+#include "2d/CCSprite.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCRenderer.h"
@@ -205,6 +207,9 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
     director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
     director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
 
+    Rect scissorRect;
+    bool useScissor = getStencilScissorRect(&scissorRect);
+
     //Add group command
         
     _groupCommand.init(_globalZOrder);
@@ -212,32 +217,42 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
 
     renderer->pushGroup(_groupCommand.getRenderQueueID());
 
-    _beforeVisitCmd.init(_globalZOrder);
-    _beforeVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onBeforeVisit, _stencilStateManager);
-    renderer->addCommand(&_beforeVisitCmd);
-    
-    auto alphaThreshold = this->getAlphaThreshold();
-    if (alphaThreshold < 1)
+    if (useScissor)
     {
+        // rectangular stencil: clip with the scissor box and skip the stencil buffer passes
+        _beforeVisitCmd.init(_globalZOrder);
+        _beforeVisitCmd.func = [renderer, scissorRect]() { renderer->pushScissorRect(scissorRect); };
+        renderer->addCommand(&_beforeVisitCmd);
+    }
+    else
+    {
+        _beforeVisitCmd.init(_globalZOrder);
+        _beforeVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onBeforeVisit, _stencilStateManager);
+        renderer->addCommand(&_beforeVisitCmd);
+
+        auto alphaThreshold = this->getAlphaThreshold();
+        if (alphaThreshold < 1)
+        {
 #if CC_CLIPPING_NODE_OPENGLES
-        // since glAlphaTest do not exists in OES, use a shader that writes
-        // pixel only if greater than an alpha threshold
-        GLProgram *program = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV);
-        GLint alphaValueLocation = glGetUniformLocation(program->getProgram(), GLProgram::UNIFORM_NAME_ALPHA_TEST_VALUE);
-        // set our alphaThreshold
-        program->use();
-        program->setUniformLocationWith1f(alphaValueLocation, alphaThreshold);
-        // we need to recursively apply this shader to all the nodes in the stencil node
-        // FIXME: we should have a way to apply shader to all nodes without having to do this
-        setProgram(_stencil, program);
+            // since glAlphaTest do not exists in OES, use a shader that writes
+            // pixel only if greater than an alpha threshold
+            GLProgram *program = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV);
+            GLint alphaValueLocation = glGetUniformLocation(program->getProgram(), GLProgram::UNIFORM_NAME_ALPHA_TEST_VALUE);
+            // set our alphaThreshold
+            program->use();
+            program->setUniformLocationWith1f(alphaValueLocation, alphaThreshold);
+            // we need to recursively apply this shader to all the nodes in the stencil node
+            // FIXME: we should have a way to apply shader to all nodes without having to do this
+            setProgram(_stencil, program);
 #endif
 
-    }
-    _stencil->visit(renderer, _modelViewTransform, flags);
+        }
+        _stencil->visit(renderer, _modelViewTransform, flags);
 
-    _afterDrawStencilCmd.init(_globalZOrder);
-    _afterDrawStencilCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterDrawStencil, _stencilStateManager);
-    renderer->addCommand(&_afterDrawStencilCmd);
+        _afterDrawStencilCmd.init(_globalZOrder);
+        _afterDrawStencilCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterDrawStencil, _stencilStateManager);
+        renderer->addCommand(&_afterDrawStencilCmd);
+    }
 
     int i = 0;
     bool visibleByCamera = isVisitableByVisitingCamera();
@@ -268,7 +283,10 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
     }
 
     _afterVisitCmd.init(_globalZOrder);
-    _afterVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterVisit, _stencilStateManager);
+    if (useScissor)
+        _afterVisitCmd.func = [renderer]() { renderer->popScissorRect(); };
+    else
+        _afterVisitCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterVisit, _stencilStateManager);
     renderer->addCommand(&_afterVisitCmd);
 
     renderer->popGroup();
@@ -276,6 +294,50 @@ void ClippingNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32
     director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
+bool ClippingNode::getStencilScissorRect(Rect* scissorRect) const
+{
+    // only a stencil that writes every fragment of a single quad is a plain rectangle
+    if (isInverted() || getAlphaThreshold() < 1 || !_stencil->isVisible() || !_stencil->getChildren().empty())
+        return false;
+
+    Rect stencilRect;
+    if (dynamic_cast<LayerColor*>(_stencil))
+    {
+        stencilRect.size = _stencil->getContentSize();
+    }
+    else if (auto sprite = dynamic_cast<Sprite*>(_stencil))
+    {
+        const auto& triangles = sprite->getPolygonInfo().triangles;
+        if (triangles.vertCount != 4 || triangles.indexCount != 6)
+            return false;
+
+        float minX = triangles.verts[0].vertices.x, maxX = minX;
+        float minY = triangles.verts[0].vertices.y, maxY = minY;
+        for (int i = 1; i < 4; ++i)
+        {
+            minX = std::min(minX, triangles.verts[i].vertices.x);
+            maxX = std::max(maxX, triangles.verts[i].vertices.x);
+            minY = std::min(minY, triangles.verts[i].vertices.y);
+            maxY = std::max(maxY, triangles.verts[i].vertices.y);
+        }
+        // custom polygons may have four vertices without being a rectangle
+        for (int i = 0; i < 4; ++i)
+        {
+            const auto& v = triangles.verts[i].vertices;
+            if ((v.x != minX && v.x != maxX) || (v.y != minY && v.y != maxY))
+                return false;
+        }
+        stencilRect.setRect(minX, minY, maxX - minX, maxY - minY);
+    }
+    else
+    {
+        return false;
+    }
+
+    Mat4 stencilTransform = _modelViewTransform * _stencil->getNodeToParentTransform();
+    return Director::getInstance()->getRenderer()->getScissorRect(stencilTransform, stencilRect, scissorRect);
+}
+
 void ClippingNode::setCameraMask(unsigned short mask, bool applyChildren)
 {
     Node::setCameraMask(mask, applyChildren);
@@ -156,6 +156,11 @@ CC_CONSTRUCTOR_ACCESS:
     virtual bool init(Node *stencil);
 
 protected:
+    /** Returns true when the stencil covers an axis-aligned rectangle on screen, so the
+     * clipping can be done with the scissor test instead of the stencil buffer.
+     */
+    bool getStencilScissorRect(Rect* scissorRect) const;
+
     Node* _stencil;
     GLProgram* _originStencilProgram;
    
@@ -63,24 +63,10 @@ void ClippingRectangleNode::setClippingRegion(const Rect &clippingRegion)
 
 void ClippingRectangleNode::onBeforeVisitScissor()
 {
-    if (_clippingEnabled) {
-        glEnable(GL_SCISSOR_TEST);
-
-        float scaleX = _scaleX;
-        float scaleY = _scaleY;
-        Node *parent = this->getParent();
-        while (parent) {
-            scaleX *= parent->getScaleX();
-            scaleY *= parent->getScaleY();
-            parent = parent->getParent();
-        }
-        
-        const Point pos = convertToWorldSpace(Point(_clippingRegion.origin.x, _clippingRegion.origin.y));
-        GLView* glView = Director::getInstance()->getOpenGLView();
-        glView->setScissorInPoints(pos.x,
-                                   pos.y,
-                                   _clippingRegion.size.width * scaleX,
-                                   _clippingRegion.size.height * scaleY);
+    if (_clippingEnabled)
+    {
+        // nested clipping nodes intersect with the scissor box of their ancestors
+        Director::getInstance()->getRenderer()->pushScissorRect(_scissorRect);
     }
 }
 
@@ -88,12 +74,38 @@ void ClippingRectangleNode::onAfterVisitScissor()
 {
     if (_clippingEnabled)
     {
-        glDisable(GL_SCISSOR_TEST);
+        Director::getInstance()->getRenderer()->popScissorRect();
     }
 }
 
+void ClippingRectangleNode::updateScissorRect(Renderer *renderer, const Mat4 &parentTransform)
+{
+    Mat4 transform = parentTransform * getNodeToParentTransform();
+    if (renderer->getScissorRect(transform, _clippingRegion, &_scissorRect))
+        return;
+
+    // not axis-aligned on screen: fall back to the scale-only projection
+    float scaleX = _scaleX;
+    float scaleY = _scaleY;
+    Node *parent = this->getParent();
+    while (parent) {
+        scaleX *= parent->getScaleX();
+        scaleY *= parent->getScaleY();
+        parent = parent->getParent();
+    }
+
+    const Point pos = convertToWorldSpace(Point(_clippingRegion.origin.x, _clippingRegion.origin.y));
+    _scissorRect.setRect(pos.x,
+                         pos.y,
+                         _clippingRegion.size.width * scaleX,
+                         _clippingRegion.size.height * scaleY);
+}
+
 void ClippingRectangleNode::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t parentFlags)
 {
+    if (_clippingEnabled)
+        updateScissorRect(renderer, parentTransform);
+
     _beforeVisitCmdScissor.init(_globalZOrder);
     _beforeVisitCmdScissor.func = CC_CALLBACK_0(ClippingRectangleNode::onBeforeVisitScissor, this);
     renderer->addCommand(&_beforeVisitCmdScissor);
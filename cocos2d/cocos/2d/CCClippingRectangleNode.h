@@ -43,7 +43,8 @@ NS_CC_BEGIN
 /**
 @brief Clipping Rectangle Node.
 @details A node that clipped with specified rectangle.
- The region of ClippingRectangleNode doesn't support any transform except scale.
+ The region follows any transform that keeps it axis-aligned on screen; other transforms only apply scale.
+ Nested ClippingRectangleNodes clip to the intersection of their regions.
 @js NA
 */
 class CC_DLL ClippingRectangleNode : public Node
@@ -101,8 +102,10 @@ protected:
     
     void onBeforeVisitScissor();
     void onAfterVisitScissor();
+    void updateScissorRect(Renderer *renderer, const Mat4 &parentTransform);
     
     Rect _clippingRegion;
+    Rect _scissorRect;
     bool _clippingEnabled;
     
     CustomCommand _beforeVisitCmdScissor;
@@ -35,6 +35,9 @@
 #include "2d/CCActionCatmullRom.h"
 #include "platform/CCGL.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 NS_CC_BEGIN
 
 // Vec2 == CGPoint in 32-bits, but not in 64-bits (OS X)
@@ -98,6 +101,25 @@ static inline Tex2F __t(const Vec2 &v)
     return *(Tex2F*)&v;
 }
 
+// unit circle points for a segment count, shared by every DrawNode;
+// point i is at angle 2*PI*i/segments and point `segments` closes the circle
+static const std::vector<Vec2>& unitCircle(unsigned int segments)
+{
+    static std::unordered_map<unsigned int, std::vector<Vec2>> s_circles;
+
+    auto& points = s_circles[segments];
+    if (points.empty())
+    {
+        const float coef = 2.0f * (float)M_PI/segments;
+        points.resize(segments + 1);
+        for (unsigned int i = 0; i <= segments; i++)
+        {
+            points[i].set(cosf(i*coef), sinf(i*coef));
+        }
+    }
+    return points;
+}
+
 // implementation of DrawNode
 
 DrawNode::DrawNode(GLfloat lineWidth)
@@ -198,7 +220,7 @@ void DrawNode::setupBuffer()
         GL::bindVAO(_vao);
         glGenBuffers(1, &_vbo);
         glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)* _bufferCapacity, _buffer, GL_STREAM_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)* _bufferCapacity, _buffer, GL_DYNAMIC_DRAW);
         // vertex
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
         glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
@@ -213,7 +235,7 @@ void DrawNode::setupBuffer()
         GL::bindVAO(_vaoGLLine);
         glGenBuffers(1, &_vboGLLine);
         glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_DYNAMIC_DRAW);
         // vertex
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
         glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
@@ -228,7 +250,7 @@ void DrawNode::setupBuffer()
         GL::bindVAO(_vaoGLPoint);
         glGenBuffers(1, &_vboGLPoint);
         glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_DYNAMIC_DRAW);
         // vertex
         glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
         glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, sizeof(V2F_C4B_T2F), (GLvoid *)offsetof(V2F_C4B_T2F, vertices));
@@ -247,19 +269,28 @@ void DrawNode::setupBuffer()
     {
         glGenBuffers(1, &_vbo);
         glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)* _bufferCapacity, _buffer, GL_STREAM_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)* _bufferCapacity, _buffer, GL_DYNAMIC_DRAW);
 
         glGenBuffers(1, &_vboGLLine);
         glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_DYNAMIC_DRAW);
 
         glGenBuffers(1, &_vboGLPoint);
         glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_DYNAMIC_DRAW);
 
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
+    GLsizei counts[BUFFER_COUNT] = { _bufferCount, _bufferCountGLPoint, _bufferCountGLLine };
+    int capacities[BUFFER_COUNT] = { _bufferCapacity, _bufferCapacityGLPoint, _bufferCapacityGLLine };
+    for (int i = 0; i < BUFFER_COUNT; ++i)
+    {
+        _bufferState[i].vboCapacity = capacities[i];
+        _bufferState[i].uploadedCount = counts[i];
+        _bufferState[i].dirtyFrom = _bufferState[i].dirtyTo = 0;
+    }
+
     CHECK_GL_ERROR_DEBUG();
 }
 
@@ -283,6 +314,20 @@ bool DrawNode::init()
 
 void DrawNode::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
+    if (_needsCompaction && _recordingPrimitive == INVALID_PRIMITIVE)
+    {
+        // removed primitives make up half of a buffer: reclaim their vertices
+        for (int i = 0; i < BUFFER_COUNT; ++i)
+        {
+            GLsizei* count;
+            bool* dirty;
+            getBuffer(i, &count, &dirty);
+            if (_bufferState[i].holeVertices * 2 > *count)
+                compactBuffer(i);
+        }
+        _needsCompaction = false;
+    }
+
     if(_bufferCount)
     {
         _customCommand.init(_globalZOrder, transform, flags);
@@ -314,9 +359,7 @@ void DrawNode::onDraw(const Mat4 &transform, uint32_t /*flags*/)
 
     if (_dirty)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacity, _buffer, GL_STREAM_DRAW);
-        
+        uploadBuffer(BUFFER_TRIANGLES, _vbo, _bufferCapacity);
         _dirty = false;
     }
     if (Configuration::getInstance()->supportsShareableVAO())
@@ -359,8 +402,7 @@ void DrawNode::onDrawGLLine(const Mat4 &transform, uint32_t /*flags*/)
 
     if (_dirtyGLLine)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLLine);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLLine, _bufferGLLine, GL_STREAM_DRAW);
+        uploadBuffer(BUFFER_GL_LINE, _vboGLLine, _bufferCapacityGLLine);
         _dirtyGLLine = false;
     }
     if (Configuration::getInstance()->supportsShareableVAO())
@@ -404,9 +446,7 @@ void DrawNode::onDrawGLPoint(const Mat4 &transform, uint32_t /*flags*/)
 
     if (_dirtyGLPoint)
     {
-        glBindBuffer(GL_ARRAY_BUFFER, _vboGLPoint);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*_bufferCapacityGLPoint, _bufferGLPoint, GL_STREAM_DRAW);
-        
+        uploadBuffer(BUFFER_GL_POINT, _vboGLPoint, _bufferCapacityGLPoint);
         _dirtyGLPoint = false;
     }
     
@@ -528,20 +568,23 @@ void DrawNode::drawPoly(const Vec2 *poli, unsigned int numberOfPoints, bool clos
     }
     
     _bufferCountGLLine += vertex_count;
+    _dirtyGLLine = true;
 }
 
 void DrawNode::drawCircle(const Vec2& center, float radius, float angle, unsigned int segments, bool drawLineToCenter, float scaleX, float scaleY, const Color4F &color)
 {
-    const float coef = 2.0f * (float)M_PI/segments;
+    const auto& circle = unitCircle(segments);
+    const float cosAngle = cosf(angle);
+    const float sinAngle = sinf(angle);
     
     Vec2 *vertices = new (std::nothrow) Vec2[segments+2];
     if( ! vertices )
         return;
     
     for(unsigned int i = 0;i <= segments; i++) {
-        float rads = i*coef;
-        GLfloat j = radius * cosf(rads + angle) * scaleX + center.x;
-        GLfloat k = radius * sinf(rads + angle) * scaleY + center.y;
+        // cos(rads + angle) and sin(rads + angle) from the cached unit circle
+        GLfloat j = radius * (circle[i].x * cosAngle - circle[i].y * sinAngle) * scaleX + center.x;
+        GLfloat k = radius * (circle[i].y * cosAngle + circle[i].x * sinAngle) * scaleY + center.y;
         
         vertices[i].x = j;
         vertices[i].y = k;
@@ -853,7 +896,9 @@ void DrawNode::drawSolidPoly(const Vec2 *poli, unsigned int numberOfPoints, cons
 
 void DrawNode::drawSolidCircle(const Vec2& center, float radius, float angle, unsigned int segments, float scaleX, float scaleY, const Color4F &color)
 {
-    const float coef = 2.0f * (float)M_PI/segments;
+    const auto& circle = unitCircle(segments);
+    const float cosAngle = cosf(angle);
+    const float sinAngle = sinf(angle);
     
     Vec2 *vertices = new (std::nothrow) Vec2[segments];
     if( ! vertices )
@@ -861,9 +906,8 @@ void DrawNode::drawSolidCircle(const Vec2& center, float radius, float angle, un
     
     for(unsigned int i = 0;i < segments; i++)
     {
-        float rads = i*coef;
-        GLfloat j = radius * cosf(rads + angle) * scaleX + center.x;
-        GLfloat k = radius * sinf(rads + angle) * scaleY + center.y;
+        GLfloat j = radius * (circle[i].x * cosAngle - circle[i].y * sinAngle) * scaleX + center.x;
+        GLfloat k = radius * (circle[i].y * cosAngle + circle[i].x * sinAngle) * scaleY + center.y;
         
         vertices[i].x = j;
         vertices[i].y = k;
@@ -911,6 +955,307 @@ void DrawNode::clear()
     _bufferCountGLPoint = 0;
     _dirtyGLPoint = true;
     _lineWidth = _defaultLineWidth;
+
+    for (auto& state : _bufferState)
+    {
+        state.uploadedCount = 0;
+        state.dirtyFrom = state.dirtyTo = 0;
+        state.holes.clear();
+        state.holeVertices = 0;
+    }
+    _primitives.clear();
+    _freePrimitives.clear();
+    _recordingPrimitive = INVALID_PRIMITIVE;
+    _needsCompaction = false;
+}
+
+V2F_C4B_T2F* DrawNode::getBuffer(int index, GLsizei** count, bool** dirty)
+{
+    switch (index)
+    {
+        case BUFFER_GL_POINT:
+            *count = &_bufferCountGLPoint;
+            *dirty = &_dirtyGLPoint;
+            return _bufferGLPoint;
+        case BUFFER_GL_LINE:
+            *count = &_bufferCountGLLine;
+            *dirty = &_dirtyGLLine;
+            return _bufferGLLine;
+        default:
+            *count = &_bufferCount;
+            *dirty = &_dirty;
+            return _buffer;
+    }
+}
+
+void DrawNode::markDirty(int index, GLsizei from, GLsizei to)
+{
+    if (from >= to)
+        return;
+
+    GLsizei* count;
+    bool* dirty;
+    getBuffer(index, &count, &dirty);
+
+    auto& state = _bufferState[index];
+    if (state.dirtyFrom >= state.dirtyTo)
+    {
+        state.dirtyFrom = from;
+        state.dirtyTo = to;
+    }
+    else
+    {
+        state.dirtyFrom = std::min(state.dirtyFrom, from);
+        state.dirtyTo = std::max(state.dirtyTo, to);
+    }
+    *dirty = true;
+}
+
+void DrawNode::uploadBuffer(int index, GLuint vbo, int capacity)
+{
+    GLsizei* count;
+    bool* dirty;
+    V2F_C4B_T2F* buffer = getBuffer(index, &count, &dirty);
+    auto& state = _bufferState[index];
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (capacity > state.vboCapacity)
+    {
+        // the CPU buffer grew: reallocate the VBO once
+        glBufferData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*capacity, buffer, GL_DYNAMIC_DRAW);
+        state.vboCapacity = capacity;
+    }
+    else
+    {
+        // vertices changed in place and vertices appended since the last upload
+        GLsizei editFrom = state.dirtyFrom;
+        GLsizei editTo = std::min(state.dirtyTo, *count);
+        GLsizei appendFrom = std::min(state.uploadedCount, *count);
+        if (editFrom < editTo && editTo >= appendFrom)
+        {
+            appendFrom = std::min(editFrom, appendFrom);
+            editTo = editFrom;
+        }
+        if (editFrom < editTo)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*editFrom, sizeof(V2F_C4B_T2F)*(editTo - editFrom), buffer + editFrom);
+        }
+        if (appendFrom < *count)
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, sizeof(V2F_C4B_T2F)*appendFrom, sizeof(V2F_C4B_T2F)*(*count - appendFrom), buffer + appendFrom);
+        }
+    }
+    state.uploadedCount = *count;
+    state.dirtyFrom = state.dirtyTo = 0;
+}
+
+int DrawNode::beginPrimitive(int handle)
+{
+    CCASSERT(_recordingPrimitive == INVALID_PRIMITIVE, "endPrimitive() was not called for the previous primitive");
+
+    if (handle == INVALID_PRIMITIVE || handle >= (int)_primitives.size() || !_primitives[handle].used)
+    {
+        Primitive primitive;
+        for (int i = 0; i < BUFFER_COUNT; ++i)
+        {
+            primitive.start[i] = primitive.count[i] = 0;
+        }
+        primitive.used = true;
+        if (_freePrimitives.empty())
+        {
+            handle = (int)_primitives.size();
+            _primitives.push_back(primitive);
+        }
+        else
+        {
+            handle = _freePrimitives.back();
+            _freePrimitives.pop_back();
+            _primitives[handle] = primitive;
+        }
+    }
+
+    _recordingPrimitive = handle;
+    _recordingStart[BUFFER_TRIANGLES] = _bufferCount;
+    _recordingStart[BUFFER_GL_POINT] = _bufferCountGLPoint;
+    _recordingStart[BUFFER_GL_LINE] = _bufferCountGLLine;
+    return handle;
+}
+
+void DrawNode::endPrimitive()
+{
+    CCASSERT(_recordingPrimitive != INVALID_PRIMITIVE, "beginPrimitive() was not called");
+    if (_recordingPrimitive == INVALID_PRIMITIVE)
+        return;
+
+    auto& primitive = _primitives[_recordingPrimitive];
+    _recordingPrimitive = INVALID_PRIMITIVE;
+
+    GLsizei newCount[BUFFER_COUNT];
+    bool sameLayout = true;
+    bool replacing = false;
+    for (int i = 0; i < BUFFER_COUNT; ++i)
+    {
+        GLsizei* count;
+        bool* dirty;
+        getBuffer(i, &count, &dirty);
+        newCount[i] = *count - _recordingStart[i];
+        sameLayout = sameLayout && newCount[i] == primitive.count[i];
+        replacing = replacing || primitive.count[i] > 0;
+    }
+
+    if (replacing && sameLayout)
+    {
+        // same vertex counts: overwrite the old vertices and drop the appended copy
+        for (int i = 0; i < BUFFER_COUNT; ++i)
+        {
+            GLsizei* count;
+            bool* dirty;
+            V2F_C4B_T2F* buffer = getBuffer(i, &count, &dirty);
+            if (newCount[i] == 0)
+                continue;
+            memcpy(buffer + primitive.start[i], buffer + _recordingStart[i], sizeof(V2F_C4B_T2F)*newCount[i]);
+            *count = _recordingStart[i];
+            _bufferState[i].uploadedCount = std::min(_bufferState[i].uploadedCount, *count);
+            markDirty(i, primitive.start[i], primitive.start[i] + newCount[i]);
+        }
+    }
+    else
+    {
+        if (replacing)
+            collapsePrimitive(primitive);
+        for (int i = 0; i < BUFFER_COUNT; ++i)
+        {
+            primitive.start[i] = _recordingStart[i];
+            primitive.count[i] = newCount[i];
+        }
+    }
+    primitive.offset = Vec2::ZERO;
+}
+
+void DrawNode::setPrimitiveOffset(int handle, const Vec2& offset)
+{
+    CCASSERT(handle >= 0 && handle < (int)_primitives.size() && _primitives[handle].used, "invalid primitive handle");
+    auto& primitive = _primitives[handle];
+    Vec2 delta = offset - primitive.offset;
+    if (delta.isZero())
+        return;
+
+    for (int i = 0; i < BUFFER_COUNT; ++i)
+    {
+        GLsizei* count;
+        bool* dirty;
+        V2F_C4B_T2F* buffer = getBuffer(i, &count, &dirty);
+        for (GLsizei v = primitive.start[i], end = primitive.start[i] + primitive.count[i]; v < end; ++v)
+        {
+            buffer[v].vertices += delta;
+        }
+        markDirty(i, primitive.start[i], primitive.start[i] + primitive.count[i]);
+    }
+    primitive.offset = offset;
+}
+
+void DrawNode::setPrimitiveColor(int handle, const Color4F& color)
+{
+    CCASSERT(handle >= 0 && handle < (int)_primitives.size() && _primitives[handle].used, "invalid primitive handle");
+    auto& primitive = _primitives[handle];
+    Color4B color4B(color);
+
+    for (int i = 0; i < BUFFER_COUNT; ++i)
+    {
+        GLsizei* count;
+        bool* dirty;
+        V2F_C4B_T2F* buffer = getBuffer(i, &count, &dirty);
+        for (GLsizei v = primitive.start[i], end = primitive.start[i] + primitive.count[i]; v < end; ++v)
+        {
+            buffer[v].colors = color4B;
+        }
+        markDirty(i, primitive.start[i], primitive.start[i] + primitive.count[i]);
+    }
+}
+
+void DrawNode::removePrimitive(int handle)
+{
+    CCASSERT(handle >= 0 && handle < (int)_primitives.size() && _primitives[handle].used, "invalid primitive handle");
+    CCASSERT(handle != _recordingPrimitive, "can't remove the primitive being recorded");
+    auto& primitive = _primitives[handle];
+
+    collapsePrimitive(primitive);
+    primitive.used = false;
+    _freePrimitives.push_back(handle);
+}
+
+void DrawNode::collapsePrimitive(const Primitive& primitive)
+{
+    for (int i = 0; i < BUFFER_COUNT; ++i)
+    {
+        if (primitive.count[i] == 0)
+            continue;
+
+        GLsizei* count;
+        bool* dirty;
+        V2F_C4B_T2F* buffer = getBuffer(i, &count, &dirty);
+
+        // degenerate, transparent, zero-sized vertices produce no fragments
+        V2F_C4B_T2F collapsed = {buffer[primitive.start[i]].vertices, Color4B(0, 0, 0, 0), Tex2F(0.0, 0.0)};
+        for (GLsizei v = primitive.start[i], end = primitive.start[i] + primitive.count[i]; v < end; ++v)
+        {
+            buffer[v] = collapsed;
+        }
+        markDirty(i, primitive.start[i], primitive.start[i] + primitive.count[i]);
+
+        auto& state = _bufferState[i];
+        state.holes.push_back(std::make_pair(primitive.start[i], primitive.count[i]));
+        state.holeVertices += primitive.count[i];
+        if (state.holeVertices * 2 > *count)
+            _needsCompaction = true;
+    }
+}
+
+void DrawNode::compactBuffer(int index)
+{
+    auto& state = _bufferState[index];
+    if (state.holes.empty())
+        return;
+
+    GLsizei* count;
+    bool* dirty;
+    V2F_C4B_T2F* buffer = getBuffer(index, &count, &dirty);
+
+    auto& holes = state.holes;
+    std::sort(holes.begin(), holes.end());
+
+    // slide the vertices between holes down
+    GLsizei write = holes[0].first;
+    for (size_t h = 0; h < holes.size(); ++h)
+    {
+        GLsizei readFrom = holes[h].first + holes[h].second;
+        GLsizei readTo = (h + 1 < holes.size()) ? holes[h + 1].first : *count;
+        memmove(buffer + write, buffer + readFrom, sizeof(V2F_C4B_T2F)*(readTo - readFrom));
+        write += readTo - readFrom;
+    }
+
+    // holes[h].second becomes the number of vertices removed up to and including hole h
+    for (size_t h = 1; h < holes.size(); ++h)
+    {
+        holes[h].second += holes[h - 1].second;
+    }
+    for (auto& primitive : _primitives)
+    {
+        if (!primitive.used || primitive.count[index] == 0)
+            continue;
+        auto it = std::upper_bound(holes.begin(), holes.end(), std::make_pair(primitive.start[index], (GLsizei)0));
+        if (it != holes.begin())
+            primitive.start[index] -= (it - 1)->second;
+    }
+
+    GLsizei firstHole = holes[0].first;
+    *count = write;
+    state.uploadedCount = std::min(state.uploadedCount, firstHole);
+    state.dirtyTo = std::min(state.dirtyTo, firstHole);
+    state.dirtyFrom = std::min(state.dirtyFrom, state.dirtyTo);
+    holes.clear();
+    state.holeVertices = 0;
+    *dirty = true;
 }
 
 const BlendFunc& DrawNode::getBlendFunc() const
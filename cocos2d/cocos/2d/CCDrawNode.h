@@ -283,6 +283,42 @@ public:
      */
     CC_DEPRECATED_ATTRIBUTE void drawQuadraticBezier(const Vec2& from, const Vec2& control, const Vec2& to, unsigned int segments, const Color4F &color);
     
+    /** Handle value that never refers to a retained primitive. */
+    static const int INVALID_PRIMITIVE = -1;
+
+    /** Starts recording a retained primitive.
+     * Everything drawn until endPrimitive() becomes one primitive that can later be moved, recolored,
+     * replaced or removed in place. Only its vertices are uploaded again, the rest of the buffers is untouched.
+     *
+     * @param handle A handle returned earlier. The geometry drawn until endPrimitive() replaces that primitive.
+     * @return The handle of the primitive, valid until it is removed or clear() is called.
+     */
+    int beginPrimitive(int handle = INVALID_PRIMITIVE);
+
+    /** Stops recording the primitive started by beginPrimitive(). */
+    void endPrimitive();
+
+    /** Moves a retained primitive by an offset relative to where it was drawn.
+     *
+     * @param handle The primitive handle.
+     * @param offset The offset in node space.
+     */
+    void setPrimitiveOffset(int handle, const Vec2& offset);
+
+    /** Replaces the color of every vertex of a retained primitive, fill and border alike.
+     *
+     * @param handle The primitive handle.
+     * @param color The new color.
+     */
+    void setPrimitiveColor(int handle, const Color4F& color);
+
+    /** Removes a retained primitive. Its vertices are collapsed in place and reclaimed
+     * once they make up half of a buffer.
+     *
+     * @param handle The primitive handle.
+     */
+    void removePrimitive(int handle);
+
     /** Clear the geometry in the node's buffer. */
     void clear();
     /** Get the color mixed mode.
@@ -341,6 +377,40 @@ protected:
 
     void setupBuffer();
 
+    // the three vertex buffers, in the order used by the per-buffer arrays below
+    enum BufferIndex
+    {
+        BUFFER_TRIANGLES,
+        BUFFER_GL_POINT,
+        BUFFER_GL_LINE,
+        BUFFER_COUNT
+    };
+
+    // what has to be sent to the VBO of one buffer
+    struct BufferState
+    {
+        GLsizei uploadedCount = 0;  // vertices already in the VBO; anything after is appended
+        GLsizei dirtyFrom = 0;      // vertices changed in place, [dirtyFrom, dirtyTo)
+        GLsizei dirtyTo = 0;
+        int     vboCapacity = 0;    // vertices the VBO can hold without glBufferData
+        std::vector<std::pair<GLsizei, GLsizei>> holes; // (start, count) left by removed primitives
+        GLsizei holeVertices = 0;
+    };
+
+    struct Primitive
+    {
+        GLsizei start[BUFFER_COUNT];
+        GLsizei count[BUFFER_COUNT];
+        Vec2    offset;
+        bool    used;
+    };
+
+    V2F_C4B_T2F* getBuffer(int index, GLsizei** count, bool** dirty);
+    void markDirty(int index, GLsizei from, GLsizei to);
+    void uploadBuffer(int index, GLuint vbo, int capacity);
+    void collapsePrimitive(const Primitive& primitive);
+    void compactBuffer(int index);
+
     GLuint      _vao = 0;
     GLuint      _vbo = 0;
     GLuint      _vaoGLPoint = 0;
@@ -367,6 +437,13 @@ protected:
     CustomCommand _customCommandGLPoint;
     CustomCommand _customCommandGLLine;
 
+    BufferState _bufferState[BUFFER_COUNT];
+    std::vector<Primitive> _primitives;
+    std::vector<int> _freePrimitives;
+    int         _recordingPrimitive = INVALID_PRIMITIVE;
+    GLsizei     _recordingStart[BUFFER_COUNT];
+    bool        _needsCompaction = false;
+
     bool        _dirty = false;
     bool        _dirtyGLPoint = false;
     bool        _dirtyGLLine = false;
@@ -44,9 +44,12 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventCustom.h"
 #include "2d/CCFontFNT.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
+CC_DEFINE_ALLOCATOR_POOL(Label)
+
 /**
  * LabelLetter used to update the quad in texture atlas without SpriteBatchNode.
  */
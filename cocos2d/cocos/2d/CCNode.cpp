@@ -45,6 +45,7 @@ THE SOFTWARE.
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCMaterial.h"
 #include "math/TransformUtils.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 
 #if CC_NODE_RENDER_SUBPIXEL
@@ -56,6 +57,8 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+CC_DEFINE_ALLOCATOR_POOL(Node)
+
 // FIXME:: Yes, nodes might have a sort problem once every 30 days if the game runs at 60 FPS and each frame sprites are reordered.
 std::uint32_t Node::s_globalOrderOfArrival = 0;
 int Node::__attachedNodeCount = 0;
@@ -83,6 +86,9 @@ Node::Node()
 , _additionalTransform(nullptr)
 , _additionalTransformDirty(false)
 , _transformUpdated(true)
+, _transformVersion(0)
+, _hitTestCount(0)
+, _hitTestMoved(false)
 // children (lazy allocs)
 // lazy alloc
 , _localZOrder$Arrival(0LL)
@@ -1703,6 +1709,9 @@ AffineTransform Node::getNodeToParentAffineTransform(Node* ancestor) const
 }
 const Mat4& Node::getNodeToParentTransform() const
 {
+    if (_transformDirty || (_additionalTransform && _transformUpdated))
+        bumpTransformVersion();
+
     if (_transformDirty)
     {
         // Translate values
@@ -1803,11 +1812,27 @@ const Mat4& Node::getNodeToParentTransform() const
     return _transform;
 }
 
+void Node::bumpTransformVersion() const
+{
+    ++_transformVersion;
+    markHitTestMoved();
+}
+
+void Node::markHitTestMoved() const
+{
+    if (_hitTestCount > 0 && !_hitTestMoved)
+    {
+        _hitTestMoved = true;
+        _eventDispatcher->_hitTestMovedNodes.push_back(const_cast<Node*>(this));
+    }
+}
+
 void Node::setNodeToParentTransform(const Mat4& transform)
 {
     _transform = transform;
     _transformDirty = false;
     _transformUpdated = true;
+    bumpTransformVersion();
 
     if (_additionalTransform)
         // _additionalTransform[1] has a copy of lastest transform
@@ -1840,6 +1865,7 @@ void Node::setAdditionalTransform(const Mat4* additionalTransform)
 
         _additionalTransform[0] = *additionalTransform;
     }
+    bumpTransformVersion();
     _transformUpdated = _additionalTransformDirty = _inverseDirty = true;
 }
 
@@ -2202,6 +2228,11 @@ bool isScreenPointInRect(const Vec2 &pt, const Camera* camera, const Mat4& w2l,
 // MARK: Camera
 void Node::setCameraMask(unsigned short mask, bool applyChildren)
 {
+    if (_cameraMask != mask)
+    {
+        // the hit test bounds depend on the camera the node is drawn with
+        markHitTestMoved();
+    }
     _cameraMask = mask;
     if (applyChildren)
     {
@@ -32,6 +32,7 @@
 
 #include <cstdint>
 #include "base/ccMacros.h"
+#include "base/allocator/CCAllocatorMacros.h"
 #include "base/CCVector.h"
 #include "base/CCProtocols.h"
 #include "base/CCScriptSupport.h"
@@ -109,6 +110,8 @@ class EventListener;
 class CC_DLL Node : public Ref
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(Node);
+
     /** Default tag used for all the nodes */
     static const int INVALID_TAG = -1;
 
@@ -1547,6 +1550,15 @@ public:
      * @return The transformation matrix.
      */
     virtual const Mat4& getNodeToParentTransform() const;
+
+    /**
+     * Returns a counter that changes every time the node-to-parent transform is rebuilt or replaced.
+     * Caches derived from getNodeToParentTransform() can compare it instead of recomputing.
+     * Note that it is only updated when getNodeToParentTransform() is called.
+     *
+     * @return The transform version.
+     */
+    unsigned int getTransformVersion() const { return _transformVersion; }
     virtual AffineTransform getNodeToParentAffineTransform() const;
 
     /**
@@ -1896,6 +1908,11 @@ protected:
     void updateRotationQuat();
     // update Rotation3D from quaternion
     void updateRotation3D();
+
+    // bumps _transformVersion, and tells the event dispatcher the hit test bounds below moved
+    void bumpTransformVersion() const;
+    // tells the event dispatcher the hit test bounds below have to be computed again
+    void markHitTestMoved() const;
     
 private:
     void addChildHelper(Node* child, int localZOrder, int tag, const std::string &name, bool setTag);
@@ -1940,6 +1957,9 @@ protected:
     mutable Mat4* _additionalTransform; ///< two transforms needed by additional transforms
     mutable bool _additionalTransformDirty; ///< transform dirty ?
     bool _transformUpdated;         ///< Whether or not the Transform object was updated since the last frame
+    mutable unsigned int _transformVersion; ///< bumped every time _transform is rebuilt or replaced
+    unsigned int _hitTestCount;     ///< listeners in the event dispatcher's hit test grid at this node or below
+    mutable bool _hitTestMoved;     ///< queued in the event dispatcher as moved since its last hit test
 
 #if CC_LITTLE_ENDIAN
     union {
@@ -2034,6 +2054,8 @@ public:
     friend class PhysicsBody;
 #endif
 
+    friend class EventDispatcher;
+
     static int __attachedNodeCount;
     
 private:
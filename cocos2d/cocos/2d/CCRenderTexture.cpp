@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "base/CCDirector.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
+#include "base/CCAsyncTaskPool.h"
 #include "renderer/CCRenderer.h"
 #include "2d/CCCamera.h"
 #include "renderer/CCTextureCache.h"
@@ -635,6 +636,109 @@ Image* RenderTexture::newImage(bool flipImage)
     return image;
 }
 
+static Image* newImageFromPixels(const Data& pixels, int width, int height, bool flipImage)
+{
+    if (pixels.isNull())
+    {
+        return nullptr;
+    }
+
+    Image *image = new (std::nothrow) Image();
+    if (image && flipImage)
+    {
+        GLubyte *buffer = new (std::nothrow) GLubyte[width * height * 4];
+        if (buffer)
+        {
+            for (int i = 0; i < height; ++i)
+            {
+                memcpy(&buffer[i * width * 4],
+                       &pixels.getBytes()[(height - i - 1) * width * 4],
+                       width * 4);
+            }
+            image->initWithRawData(buffer, width * height * 4, width, height, 8);
+            delete[] buffer;
+        }
+    }
+    else if (image)
+    {
+        image->initWithRawData(pixels.getBytes(), width * height * 4, width, height, 8);
+    }
+    return image;
+}
+
+void RenderTexture::newImageAsync(const std::function<void(Image*)>& callback, bool flipImage)
+{
+    CCASSERT(_pixelFormat == Texture2D::PixelFormat::RGBA8888, "only RGBA8888 can be saved as image");
+
+    readPixelsAsync([this, callback, flipImage](Data& pixels, int width, int height) {
+        auto buffer = std::make_shared<Data>(std::move(pixels));
+        auto image = std::make_shared<Image*>(nullptr);
+        // flipping and copying a large texture is left to a worker thread as well
+        AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_OTHER, [this, callback, image](void* /*param*/) {
+            if (callback)
+            {
+                callback(*image);
+            }
+            else
+            {
+                CC_SAFE_DELETE(*image);
+            }
+            release();
+        }, nullptr, [buffer, image, width, height, flipImage]() {
+            *image = newImageFromPixels(*buffer, width, height, flipImage);
+        });
+    });
+}
+
+bool RenderTexture::saveToFileAsync(const std::string& fileName, Image::Format format, bool isRGBA, std::function<void (RenderTexture*, const std::string&, bool)> callback)
+{
+    CCASSERT(format == Image::Format::JPG || format == Image::Format::PNG,
+             "the image can only be saved as JPG or PNG format");
+    CCASSERT(_pixelFormat == Texture2D::PixelFormat::RGBA8888, "only RGBA8888 can be saved as image");
+    if (isRGBA && format == Image::Format::JPG) CCLOG("RGBA is not supported for JPG format");
+
+    std::string fullpath = FileUtils::getInstance()->getWritablePath() + fileName;
+    readPixelsAsync([this, fullpath, isRGBA, callback](Data& pixels, int width, int height) {
+        auto buffer = std::make_shared<Data>(std::move(pixels));
+        auto succeed = std::make_shared<bool>(false);
+        AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [this, fullpath, callback, succeed](void* /*param*/) {
+            if (callback)
+            {
+                callback(this, fullpath, *succeed);
+            }
+            release();
+        }, nullptr, [buffer, fullpath, isRGBA, width, height, succeed]() {
+            Image *image = newImageFromPixels(*buffer, width, height, true);
+            if (image)
+            {
+                *succeed = image->saveToFile(fullpath, !isRGBA);
+            }
+            CC_SAFE_DELETE(image);
+        });
+    });
+    return true;
+}
+
+void RenderTexture::readPixelsAsync(const std::function<void(Data&, int, int)>& callback)
+{
+    // released by the completion callbacks on the cocos thread
+    retain();
+
+    _readPixelsCommand.init(_globalZOrder);
+    _readPixelsCommand.func = CC_CALLBACK_0(RenderTexture::onReadPixelsAsync, this, callback);
+    Director::getInstance()->getRenderer()->addCommand(&_readPixelsCommand);
+}
+
+void RenderTexture::onReadPixelsAsync(const std::function<void(Data&, int, int)>& callback)
+{
+    const Size& s = _texture->getContentSizeInPixels();
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_oldFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
+    Director::getInstance()->getRenderer()->readPixelsAsync(0, 0, (int)s.width, (int)s.height, callback);
+    glBindFramebuffer(GL_FRAMEBUFFER, _oldFBO);
+}
+
 void RenderTexture::onBegin()
 {
     //
@@ -36,6 +36,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class EventCustom;
+class Data;
 
 /**
  * @addtogroup _2d
@@ -151,6 +152,15 @@ public:
     
     CC_DEPRECATED_ATTRIBUTE Image* newCCImage(bool flipImage = true) { return newImage(flipImage); };
 
+    /** Reads the texture without stalling on the GPU and delivers it as an Image a frame or two later.
+     * Like saveToFile(), the read happens in the following render->render(), after what was drawn before.
+     *
+     * @param callback Invoked on the cocos thread. It owns the image, which is nullptr if the read failed.
+     * @param flipImage Whether or not to flip image.
+     * @js NA
+     */
+    void newImageAsync(const std::function<void(Image*)>& callback, bool flipImage = true);
+
     /** Saves the texture into a file using JPEG format. The file will be saved in the Documents folder.
      * Returns true if the operation is successful.
      *
@@ -174,6 +184,18 @@ public:
      * @return Returns true if the operation is successful.
      */
     bool saveToFile(const std::string& filename, Image::Format format, bool isRGBA = true, std::function<void (RenderTexture*, const std::string&)> callback = nullptr);
+
+    /** Saves the texture into a file like saveToFile(), but the pixels are read asynchronously
+     * and the image is encoded on a worker thread.
+     * The render texture is retained until the callback has been invoked on the cocos thread.
+     *
+     * @param fileName The file name.
+     * @param format The image format.
+     * @param isRGBA The file is RGBA or not.
+     * @param callback Invoked on the cocos thread once the file is written, with whether it succeeded.
+     * @return Returns true if the operation is successful.
+     */
+    bool saveToFileAsync(const std::string& fileName, Image::Format format, bool isRGBA = true, std::function<void (RenderTexture*, const std::string&, bool)> callback = nullptr);
     
     /** Listen "come to background" message, and save render texture.
      * It only has effect on Android.
@@ -355,6 +377,8 @@ protected:
     */
     CustomCommand _saveToFileCommand;
     std::function<void (RenderTexture*, const std::string&)> _saveFileCallback;
+    /* issues the reads of newImageAsync() and saveToFileAsync(); same caveat as _saveToFileCommand */
+    CustomCommand _readPixelsCommand;
 protected:
     //renderer caches and callbacks
     void onBegin();
@@ -364,6 +388,8 @@ protected:
     void onClearDepth();
 
     void onSaveToFile(const std::string& fileName, bool isRGBA = true);
+    void readPixelsAsync(const std::function<void(Data&, int, int)>& callback);
+    void onReadPixelsAsync(const std::function<void(Data&, int, int)>& callback);
 
     void setupDepthAndStencil(int powW, int powH);
     
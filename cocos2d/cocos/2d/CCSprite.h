@@ -96,6 +96,8 @@ struct transformValues_;
 class CC_DLL Sprite : public Node, public TextureProtocol
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(Sprite);
+
     enum class RenderMode {
         QUAD,
         POLYGON,
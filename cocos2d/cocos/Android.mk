@@ -25,6 +25,7 @@ cocos2d.cpp \
 2d/CCActionInstant.cpp \
 2d/CCActionInterval.cpp \
 2d/CCActionManager.cpp \
+2d/CCActionTemplate.cpp \
 2d/CCActionPageTurn3D.cpp \
 2d/CCActionProgressTimer.cpp \
 2d/CCActionTiledGrid.cpp \
@@ -108,6 +109,8 @@ math/Vec4.cpp \
 base/CCNinePatchImageParser.cpp \
 base/CCStencilStateManager.cpp \
 base/CCAsyncTaskPool.cpp \
+base/CCWorkerPool.cpp \
+base/CCFrameArena.cpp \
 base/CCAutoreleasePool.cpp \
 base/CCConfiguration.cpp \
 base/CCConsole.cpp \
@@ -28,6 +28,22 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+#if CC_ENABLE_ATOMIC_REF_COUNT
+// Objects autoreleased on a worker thread, invisible to the cocos thread until PoolManager::flushThreadReleases().
+struct ThreadReleases
+{
+    std::vector<Ref*> objects;
+
+    ~ThreadReleases()
+    {
+        if (!objects.empty())
+            PoolManager::getInstance()->flushThreadReleases();
+    }
+};
+
+static thread_local ThreadReleases s_threadReleases;
+#endif
+
 AutoreleasePool::AutoreleasePool()
 : _name("")
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
@@ -124,6 +140,8 @@ void PoolManager::destroyInstance()
 }
 
 PoolManager::PoolManager()
+: _deferredReleases(nullptr)
+, _cocosThreadId(std::this_thread::get_id())
 {
     _releasePoolStack.reserve(10);
 }
@@ -132,6 +150,8 @@ PoolManager::~PoolManager()
 {
     CCLOGINFO("deallocing PoolManager: %p", this);
     
+    drainDeferredReleases();
+
     while (!_releasePoolStack.empty())
     {
         AutoreleasePool* pool = _releasePoolStack.back();
@@ -156,6 +176,79 @@ bool PoolManager::isObjectInPools(Ref* obj) const
     return false;
 }
 
+void PoolManager::deferRelease(Ref *object)
+{
+    CCASSERT(object, "Invalid parameter, object should not be null!");
+    DeferredRelease *node = new DeferredRelease();
+    node->object = object;
+    pushDeferredReleases(node, node);
+}
+
+void PoolManager::flushThreadReleases()
+{
+#if CC_ENABLE_ATOMIC_REF_COUNT
+    auto& objects = s_threadReleases.objects;
+    if (objects.empty())
+        return;
+
+    // chain them newest first like the stack, so they are drained in the order they were autoreleased
+    DeferredRelease *first = nullptr;
+    DeferredRelease *last = nullptr;
+    for (const auto& object : objects)
+    {
+        DeferredRelease *node = new DeferredRelease();
+        node->object = object;
+        node->next = first;
+        first = node;
+        if (!last)
+            last = node;
+    }
+    objects.clear();
+    pushDeferredReleases(first, last);
+#endif
+}
+
+void PoolManager::addThreadRelease(Ref *object)
+{
+#if CC_ENABLE_ATOMIC_REF_COUNT
+    s_threadReleases.objects.push_back(object);
+#else
+    getCurrentPool()->addObject(object);
+#endif
+}
+
+void PoolManager::pushDeferredReleases(DeferredRelease *first, DeferredRelease *last)
+{
+    last->next = _deferredReleases.load(std::memory_order_relaxed);
+    // nodes are only ever taken all at once, so the stack has no ABA problem
+    while (!_deferredReleases.compare_exchange_weak(last->next, first, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+void PoolManager::drainDeferredReleases()
+{
+    CCASSERT(isCocosThread(), "Deferred releases must be drained on the cocos thread");
+    DeferredRelease *node = _deferredReleases.exchange(nullptr, std::memory_order_acquire);
+    if (!node)
+        return;
+
+    // the stack holds the newest first
+    while (node)
+    {
+        DeferredRelease *next = node->next;
+        _releasing.push_back(node->object);
+        delete node;
+        node = next;
+    }
+    // releases deferred by the destructors run here wait for the next drain
+    for (auto it = _releasing.rbegin(); it != _releasing.rend(); ++it)
+    {
+        (*it)->release();
+    }
+    _releasing.clear();
+}
+
 void PoolManager::push(AutoreleasePool *pool)
 {
     _releasePoolStack.push_back(pool);
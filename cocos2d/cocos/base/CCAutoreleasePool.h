@@ -28,6 +28,8 @@ THE SOFTWARE.
 
 #include <vector>
 #include <string>
+#include <atomic>
+#include <thread>
 #include "base/CCRef.h"
 
 /**
@@ -168,8 +170,30 @@ public:
 
     bool isObjectInPools(Ref* obj) const;
 
+    /** Whether the calling thread is the one that created the pool manager, the cocos thread. */
+    bool isCocosThread() const { return std::this_thread::get_id() == _cocosThreadId; }
+
+    /**
+     * Queues a release of the object that is made on the cocos thread by the next
+     * drainDeferredReleases(). Safe to call from any thread, it never blocks.
+     * Objects shared between threads need CC_ENABLE_ATOMIC_REF_COUNT.
+     */
+    void deferRelease(Ref *object);
+
+    /** Releases the objects queued with deferRelease(), in the order they were queued. Called by Director once per frame. */
+    void drainDeferredReleases();
+
+    /**
+     * Queues the objects autoreleased on the calling worker thread since its last flush
+     * with deferRelease(). Until then they are private to the worker, so call it at the
+     * hand-off point, after retaining whatever has to outlive its autorelease.
+     * A worker flushes when it exits too. Does nothing on the cocos thread, or unless
+     * CC_ENABLE_ATOMIC_REF_COUNT is on.
+     */
+    void flushThreadReleases();
 
     friend class AutoreleasePool;
+    friend class Ref;
     
 private:
     PoolManager();
@@ -177,10 +201,24 @@ private:
     
     void push(AutoreleasePool *pool);
     void pop();
+
+    // A node of the lock-free stack of deferred releases, pushed by any thread and taken whole by the cocos thread.
+    struct DeferredRelease
+    {
+        Ref *object;
+        DeferredRelease *next;
+    };
+
+    void addThreadRelease(Ref *object);
+    void pushDeferredReleases(DeferredRelease *first, DeferredRelease *last);
     
     static PoolManager* s_singleInstance;
     
     std::vector<AutoreleasePool*> _releasePoolStack;
+
+    std::atomic<DeferredRelease*> _deferredReleases;
+    std::vector<Ref*> _releasing;
+    std::thread::id _cocosThreadId;
 };
 /**
  * @endcond
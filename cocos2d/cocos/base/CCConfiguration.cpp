@@ -53,6 +53,8 @@ Configuration::Configuration()
 , _supportsOESMapBuffer(false)
 , _supportsOESDepth24(false)
 , _supportsOESPackedDepthStencil(false)
+, _supportsProgramBinary(false)
+, _supportsPixelBufferObject(false)
 , _maxSamplesAllowed(0)
 , _maxTextureUnits(0)
 , _glExtensions(nullptr)
@@ -168,6 +170,28 @@ void Configuration::gatherGPUInfo()
     _supportsOESPackedDepthStencil = checkForGLExtension("GL_OES_packed_depth_stencil");
     _valueDict["gl.supports_OES_packed_depth_stencil"] = Value(_supportsOESPackedDepthStencil);
 
+#if CC_ENABLE_GLPROGRAM_BINARY_CACHE
+#ifdef CC_PLATFORM_PC
+    _supportsProgramBinary = checkForGLExtension("GL_ARB_get_program_binary");
+#else
+    _supportsProgramBinary = checkForGLExtension("GL_OES_get_program_binary");
+#endif
+    if (_supportsProgramBinary)
+    {
+        GLint numFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+        _supportsProgramBinary = numFormats > 0;
+    }
+#endif
+    _valueDict["gl.supports_program_binary"] = Value(_supportsProgramBinary);
+
+#ifdef CC_PLATFORM_PC
+    _supportsPixelBufferObject = checkForGLExtension("GL_ARB_pixel_buffer_object");
+#elif defined(GL_PIXEL_PACK_BUFFER) && defined(GL_MAP_READ_BIT)
+    _supportsPixelBufferObject = _valueDict["gl.version"].asString().find("OpenGL ES 3") != std::string::npos;
+#endif
+    _valueDict["gl.supports_pixel_buffer_object"] = Value(_supportsPixelBufferObject);
+
 
     CHECK_GL_ERROR_DEBUG();
 }
@@ -295,6 +319,16 @@ bool Configuration::supportsMapBuffer() const
 #endif
 }
 
+bool Configuration::supportsProgramBinary() const
+{
+    return _supportsProgramBinary;
+}
+
+bool Configuration::supportsPixelBufferObject() const
+{
+    return _supportsPixelBufferObject;
+}
+
 bool Configuration::supportsOESDepth24() const
 {
     return _supportsOESDepth24;
@@ -171,6 +171,25 @@ public:
      */
     bool supportsMapBuffer() const;
 
+    /** Whether or not glGetProgramBinary() / glProgramBinary() are supported.
+     *
+     * On Desktop it checks for the extension `GL_ARB_get_program_binary`.
+     * On Mobile it checks for the extension `GL_OES_get_program_binary`.
+     * In both cases the driver must also expose at least one binary format.
+     *
+     * @return Whether or not program binaries are supported.
+     */
+    bool supportsProgramBinary() const;
+
+    /** Whether or not glReadPixels() can write into a GL_PIXEL_PACK_BUFFER that is mapped later.
+     *
+     * On Desktop it checks for the extension `GL_ARB_pixel_buffer_object`.
+     * On Mobile it requires OpenGL ES 3.0 headers and context.
+     *
+     * @return Whether or not pixel buffer objects are supported.
+     */
+    bool supportsPixelBufferObject() const;
+
     
     /** Max support directional light in shader, for Sprite3D.
      *
@@ -270,6 +289,8 @@ protected:
     bool            _supportsOESMapBuffer;
     bool            _supportsOESDepth24;
     bool            _supportsOESPackedDepthStencil;
+    bool            _supportsProgramBinary;
+    bool            _supportsPixelBufferObject;
     
     GLint           _maxSamplesAllowed;
     GLint           _maxTextureUnits;
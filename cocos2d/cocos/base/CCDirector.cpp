@@ -61,6 +61,8 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCWorkerPool.h"
+#include "base/CCFrameArena.h"
 #include "base/ObjectFactory.h"
 #include "platform/CCApplication.h"
 
@@ -68,6 +70,10 @@ THE SOFTWARE.
 #include "base/CCScriptSupport.h"
 #endif
 
+#if CC_USE_PHYSICS
+#include "physics/CCPhysicsWorld.h"
+#endif
+
 /**
  Position of the FPS
  
@@ -155,6 +161,7 @@ bool Director::init()
     initMatrixStack();
 
     _renderer = new (std::nothrow) Renderer;
+    _frameArena = new (std::nothrow) FrameArena;
     RenderState::initialize();
 
     return true;
@@ -167,6 +174,8 @@ Director::~Director()
     CC_SAFE_RELEASE(_FPSLabel);
     CC_SAFE_RELEASE(_drawnVerticesLabel);
     CC_SAFE_RELEASE(_drawnBatchesLabel);
+    CC_SAFE_RELEASE(_physicsTimesLabel);
+    CC_SAFE_RELEASE(_physicsCountsLabel);
 
     CC_SAFE_RELEASE(_runningScene);
     CC_SAFE_RELEASE(_notificationNode);
@@ -187,6 +196,7 @@ Director::~Director()
     delete _console;
 
     CC_SAFE_RELEASE(_eventDispatcher);
+    delete _frameArena;
     
     Configuration::destroyInstance();
     ObjectFactory::destroyInstance();
@@ -313,6 +323,7 @@ void Director::drawScene()
     }
     
     _renderer->render();
+    _frameArena->reset();
 
     _eventDispatcher->dispatchEvent(_eventAfterDraw);
 
@@ -326,6 +337,14 @@ void Director::drawScene()
         _openGLView->swapBuffers();
     }
 
+#if CC_USE_PHYSICS
+    // physics stepped on a worker thread while this frame was drawn, sync before the next tick
+    if (_runningScene && _runningScene->getPhysicsWorld())
+    {
+        _runningScene->getPhysicsWorld()->finishAsyncStep();
+    }
+#endif
+
     if (_displayStats)
     {
 #if !CC_STRIP_FPS
@@ -1073,6 +1092,8 @@ void Director::reset()
     CC_SAFE_RELEASE_NULL(_FPSLabel);
     CC_SAFE_RELEASE_NULL(_drawnBatchesLabel);
     CC_SAFE_RELEASE_NULL(_drawnVerticesLabel);
+    CC_SAFE_RELEASE_NULL(_physicsTimesLabel);
+    CC_SAFE_RELEASE_NULL(_physicsCountsLabel);
     
     // purge bitmap cache
     FontFNT::purgeCachedData();
@@ -1103,6 +1124,7 @@ void Director::reset()
     GLProgramStateCache::destroyInstance();
     FileUtils::destroyInstance();
     AsyncTaskPool::destroyInstance();
+    WorkerPool::destroyInstance();
     
     // cocos2d-x specific data structures
     UserDefault::destroyInstance();
@@ -1145,6 +1167,7 @@ void Director::restartDirector()
     getScheduler()->scheduleUpdate(getActionManager(), Scheduler::PRIORITY_SYSTEM, false);
     
     // release the objects
+    PoolManager::getInstance()->drainDeferredReleases();
     PoolManager::getInstance()->getCurrentPool()->clear();
 
     // Restart animation
@@ -1265,12 +1288,14 @@ void Director::showStats()
         // Probably we don't need this anymore since
         // the framerate is using a low-pass filter
         // to make the FPS stable
+        bool updateInterval = false;
         if (_accumDt > CC_DIRECTOR_STATS_INTERVAL)
         {
             sprintf(buffer, "%.1f / %.3f", _frames / _accumDt, _secondsPerFrame);
             _FPSLabel->setString(buffer);
             _accumDt = 0;
             _frames = 0;
+            updateInterval = true;
         }
 
         auto currentCalls = (unsigned long)_renderer->getDrawnBatches();
@@ -1288,6 +1313,23 @@ void Director::showStats()
         }
 
         const Mat4& identity = Mat4::IDENTITY;
+#if CC_USE_PHYSICS
+        // step / sync / dispatch ms, and broadphase pairs / arbiters / contacts / sleeping bodies
+        auto physicsWorld = _runningScene ? _runningScene->getPhysicsWorld() : nullptr;
+        if (physicsWorld && _physicsTimesLabel && _physicsCountsLabel)
+        {
+            if (updateInterval)
+            {
+                const auto& stats = physicsWorld->getStats();
+                snprintf(buffer, sizeof(buffer), "Phys:%5.2f/%5.2f/%5.2f", stats.stepTime, stats.syncTime, stats.dispatchTime);
+                _physicsTimesLabel->setString(buffer);
+                snprintf(buffer, sizeof(buffer), "Pairs:%4d/%4d/%4d Zz:%4d", stats.broadphasePairs, stats.arbiters, stats.contacts, stats.sleepingBodies);
+                _physicsCountsLabel->setString(buffer);
+            }
+            _physicsCountsLabel->visit(_renderer, identity, 0);
+            _physicsTimesLabel->visit(_renderer, identity, 0);
+        }
+#endif
         _drawnVerticesLabel->visit(_renderer, identity, 0);
         _drawnBatchesLabel->visit(_renderer, identity, 0);
         _FPSLabel->visit(_renderer, identity, 0);
@@ -1317,15 +1359,21 @@ void Director::createStatsLabel()
     std::string fpsString = "00.0";
     std::string drawBatchString = "000";
     std::string drawVerticesString = "00000";
+    std::string physicsTimesString = "Phys:";
+    std::string physicsCountsString = "Pairs:";
     if (_FPSLabel)
     {
         fpsString = _FPSLabel->getString();
         drawBatchString = _drawnBatchesLabel->getString();
         drawVerticesString = _drawnVerticesLabel->getString();
+        physicsTimesString = _physicsTimesLabel->getString();
+        physicsCountsString = _physicsCountsLabel->getString();
         
         CC_SAFE_RELEASE_NULL(_FPSLabel);
         CC_SAFE_RELEASE_NULL(_drawnBatchesLabel);
         CC_SAFE_RELEASE_NULL(_drawnVerticesLabel);
+        CC_SAFE_RELEASE_NULL(_physicsTimesLabel);
+        CC_SAFE_RELEASE_NULL(_physicsCountsLabel);
         _textureCache->removeTextureForKey("/cc_fps_images");
         FileUtils::getInstance()->purgeCachedEntries();
     }
@@ -1376,10 +1424,24 @@ void Director::createStatsLabel()
     _drawnVerticesLabel->initWithString(drawVerticesString, texture, 12, 32, '.');
     _drawnVerticesLabel->setScale(scaleFactor);
 
+    _physicsTimesLabel = LabelAtlas::create();
+    _physicsTimesLabel->retain();
+    _physicsTimesLabel->setIgnoreContentScaleFactor(true);
+    _physicsTimesLabel->initWithString(physicsTimesString, texture, 12, 32, '.');
+    _physicsTimesLabel->setScale(scaleFactor);
+
+    _physicsCountsLabel = LabelAtlas::create();
+    _physicsCountsLabel->retain();
+    _physicsCountsLabel->setIgnoreContentScaleFactor(true);
+    _physicsCountsLabel->initWithString(physicsCountsString, texture, 12, 32, '.');
+    _physicsCountsLabel->setScale(scaleFactor);
+
 
     Texture2D::setDefaultAlphaPixelFormat(currentFormat);
 
     const int height_spacing = 22 / CC_CONTENT_SCALE_FACTOR();
+    _physicsCountsLabel->setPosition(Vec2(0, height_spacing*4) + CC_DIRECTOR_STATS_POSITION);
+    _physicsTimesLabel->setPosition(Vec2(0, height_spacing*3) + CC_DIRECTOR_STATS_POSITION);
     _drawnVerticesLabel->setPosition(Vec2(0, height_spacing*2) + CC_DIRECTOR_STATS_POSITION);
     _drawnBatchesLabel->setPosition(Vec2(0, height_spacing*1) + CC_DIRECTOR_STATS_POSITION);
     _FPSLabel->setPosition(Vec2(0, height_spacing*0)+CC_DIRECTOR_STATS_POSITION);
@@ -1475,6 +1537,7 @@ void Director::mainLoop()
         drawScene();
      
         // release the objects
+        PoolManager::getInstance()->drainDeferredReleases();
         PoolManager::getInstance()->getCurrentPool()->clear();
     }
 }
@@ -60,6 +60,7 @@ class EventCustom;
 class EventListenerCustom;
 class TextureCache;
 class Renderer;
+class FrameArena;
 class Camera;
 
 class Console;
@@ -465,6 +466,11 @@ public:
      */
     Console* getConsole() const { return _console; }
 
+    /** Returns the arena for temporaries of the current frame. It is reset once the frame is rendered.
+     * @js NA
+     */
+    FrameArena* getFrameArena() const { return _frameArena; }
+
     /* Gets delta time since last tick to main loop. */
 	float getDeltaTime() const;
     
@@ -668,6 +674,9 @@ protected:
     LabelAtlas *_FPSLabel = nullptr;
     LabelAtlas *_drawnBatchesLabel = nullptr;
     LabelAtlas *_drawnVerticesLabel = nullptr;
+    // physics stats of the running scene, only shown when it has a physics world
+    LabelAtlas *_physicsTimesLabel = nullptr;
+    LabelAtlas *_physicsCountsLabel = nullptr;
     
     /** Whether or not the Director is paused */
     bool _paused = false;
@@ -714,6 +723,9 @@ protected:
     /* Console for the director */
     Console *_console = nullptr;
 
+    /* Temporaries of the frame, reset after Renderer::render */
+    FrameArena *_frameArena = nullptr;
+
     bool _isStatusLabelUpdated = true;
 
     /* cocos2d thread id */
@@ -28,6 +28,7 @@
 
 #include <string>
 #include "base/CCEvent.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 /**
  * @addtogroup base
@@ -42,6 +43,8 @@ NS_CC_BEGIN
 class CC_DLL EventCustom : public Event
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(EventCustom);
+
     /** Constructor.
      *
      * @param eventName A given name of the custom event.
@@ -24,6 +24,7 @@
  ****************************************************************************/
 #include "base/CCEventDispatcher.h"
 #include <algorithm>
+#include <limits>
 
 #include "base/CCEventCustom.h"
 #include "base/CCEventListenerTouch.h"
@@ -37,6 +38,7 @@
 #endif
 #include "2d/CCScene.h"
 #include "base/CCDirector.h"
+#include "base/CCFrameArena.h"
 #include "base/CCEventType.h"
 #include "2d/CCCamera.h"
 
@@ -180,6 +182,7 @@ void EventDispatcher::EventListenerVector::clearSceneGraphListeners()
         delete _sceneGraphListeners;
         _sceneGraphListeners = nullptr;
     }
+    _unboundedListeners.clear();
 }
 
 void EventDispatcher::EventListenerVector::clearFixedListeners()
@@ -202,7 +205,8 @@ void EventDispatcher::EventListenerVector::clear()
 EventDispatcher::EventDispatcher()
 : _inDispatch(0)
 , _isEnabled(false)
-, _nodePriorityIndex(0)
+, _sceneGraphDirty(false)
+, _hitTestCellSize(64.f)
 {
     _toAddedListeners.reserve(50);
     _toRemovedListeners.reserve(50);
@@ -222,73 +226,25 @@ EventDispatcher::~EventDispatcher()
     removeAllEventListeners();
 }
 
-void EventDispatcher::visitTarget(Node* node, bool isRootNode)
+void EventDispatcher::computeNodeOrderKey(Node* node, Node* rootNode, NodeOrderKey& key)
 {
-    node->sortAllChildren();
-    
-    int i = 0;
-    auto& children = node->getChildren();
-    
-    auto childrenCount = children.size();
-    
-    if(childrenCount > 0)
-    {
-        Node* child = nullptr;
-        // visit children zOrder < 0
-        for( ; i < childrenCount; i++ )
-        {
-            child = children.at(i);
-            
-            if ( child && child->getLocalZOrder() < 0 )
-                visitTarget(child, false);
-            else
-                break;
-        }
-        
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
-        {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
-        }
-        
-        for( ; i < childrenCount; i++ )
-        {
-            child = children.at(i);
-            if (child)
-                visitTarget(child, false);
-        }
-    }
-    else
-    {
-        if (_nodeListenersMap.find(node) != _nodeListenersMap.end())
-        {
-            _globalZOrderNodeMap[node->getGlobalZOrder()].push_back(node);
-        }
-    }
-    
-    if (isRootNode)
+    // The scene graph is drawn children with a negative local z order first, then the node, then the other
+    // children, siblings in the order of their local z order and order of arrival. So the position of the
+    // node in the draw order is the path of those orders from the scene down to it, followed by 0, which
+    // sorts after its children with a negative local z order and before the others.
+    key.pathBegin = _nodeOrderPaths.size();
+    _nodeOrderPaths.push_back(0);
+
+    Node* ancestor = node;
+    for (; ancestor != rootNode && ancestor->getParent() != nullptr; ancestor = ancestor->getParent())
     {
-        std::vector<float> globalZOrders;
-        globalZOrders.reserve(_globalZOrderNodeMap.size());
-        
-        for (const auto& e : _globalZOrderNodeMap)
-        {
-            globalZOrders.push_back(e.first);
-        }
-        
-        std::stable_sort(globalZOrders.begin(), globalZOrders.end(), [](const float a, const float b){
-            return a < b;
-        });
-        
-        for (const auto& globalZ : globalZOrders)
-        {
-            for (const auto& n : _globalZOrderNodeMap[globalZ])
-            {
-                _nodePriorityMap[n] = ++_nodePriorityIndex;
-            }
-        }
-        
-        _globalZOrderNodeMap.clear();
+        _nodeOrderPaths.push_back(ancestor->_localZOrder$Arrival);
     }
+
+    key.pathEnd = _nodeOrderPaths.size();
+    key.inScene = (ancestor == rootNode);
+    key.globalZOrder = node->getGlobalZOrder();
+    std::reverse(_nodeOrderPaths.begin() + key.pathBegin, _nodeOrderPaths.end());
 }
 
 void EventDispatcher::pauseEventListenersForTarget(Node* target, bool recursive/* = false */)
@@ -300,6 +256,12 @@ void EventDispatcher::pauseEventListenersForTarget(Node* target, bool recursive/
         for (auto& l : *listeners)
         {
             l->setPaused(true);
+
+            // taken out of the grid while the node is still attached to its ancestors
+            if (l->_hitTestIndex >= 0 && _hitTestEntries[l->_hitTestIndex].valid)
+            {
+                eraseHitTestEntry(_hitTestEntries[l->_hitTestIndex]);
+            }
         }
     }
 
@@ -330,6 +292,12 @@ void EventDispatcher::resumeEventListenersForTarget(Node* target, bool recursive
         for (auto& l : *listeners)
         {
             l->setPaused(false);
+
+            // the node may have moved or changed parents while it was paused
+            if (l->_hitTestIndex >= 0)
+            {
+                queueHitTestEntry(_hitTestEntries[l->_hitTestIndex]);
+            }
         }
     }
     
@@ -357,7 +325,6 @@ void EventDispatcher::removeEventListenersForTarget(Node* target, bool recursive
 {
     // Ensure the node is removed from these immediately also.
     // Don't want any dangling pointers or the possibility of dealing with deleted objects..
-    _nodePriorityMap.erase(target);
     _dirtyNodes.erase(target);
 
     auto listenerIter = _nodeListenersMap.find(target);
@@ -418,10 +385,20 @@ void EventDispatcher::associateNodeAndEventListener(Node* node, EventListener* l
     }
     
     listeners->push_back(listener);
+
+    if (listener->_hitTestBounds && (listener->getType() == EventListener::Type::TOUCH_ONE_BY_ONE || listener->getType() == EventListener::Type::MOUSE))
+    {
+        addHitTestEntry(listener);
+    }
 }
 
 void EventDispatcher::dissociateNodeAndEventListener(Node* node, EventListener* listener)
 {
+    if (listener->_hitTestIndex >= 0)
+    {
+        removeHitTestEntry(listener);
+    }
+
     std::vector<EventListener*>* listeners = nullptr;
     auto found = _nodeListenersMap.find(node);
     if (found != _nodeListenersMap.end())
@@ -441,6 +418,258 @@ void EventDispatcher::dissociateNodeAndEventListener(Node* node, EventListener*
     }
 }
 
+// An entry covering more cells is tested on its own
+static const float HIT_TEST_MAX_CELLS = 64.f;
+
+static std::int64_t hitTestCellKey(int x, int y)
+{
+    return (static_cast<std::int64_t>(x) << 32) | static_cast<std::uint32_t>(y);
+}
+
+void EventDispatcher::addHitTestEntry(EventListener* listener)
+{
+    HitTestEntry entry;
+    entry.listener = listener;
+    entry.valid = false;
+    entry.queued = false;
+    entry.order = -1;
+    entry.cellX0 = entry.cellY0 = entry.cellX1 = entry.cellY1 = 0;
+    entry.large = false;
+
+    listener->_hitTestIndex = static_cast<int>(_hitTestEntries.size());
+    _hitTestEntries.push_back(entry);
+
+    // paused listeners are queued once they are resumed
+    if (!listener->isPaused())
+    {
+        queueHitTestEntry(_hitTestEntries.back());
+    }
+}
+
+void EventDispatcher::removeHitTestEntry(EventListener* listener)
+{
+    const int index = listener->_hitTestIndex;
+    if (_hitTestEntries[index].valid)
+    {
+        eraseHitTestEntry(_hitTestEntries[index]);
+    }
+    if (_hitTestEntries[index].queued)
+    {
+        auto iter = std::find(_hitTestQueue.begin(), _hitTestQueue.end(), listener);
+        *iter = _hitTestQueue.back();
+        _hitTestQueue.pop_back();
+    }
+
+    listener->_hitTestIndex = -1;
+    if (index + 1 < static_cast<int>(_hitTestEntries.size()))
+    {
+        _hitTestEntries[index] = _hitTestEntries.back();
+        _hitTestEntries[index].listener->_hitTestIndex = index;
+    }
+    _hitTestEntries.pop_back();
+}
+
+void EventDispatcher::queueHitTestEntry(HitTestEntry& entry)
+{
+    if (!entry.queued)
+    {
+        entry.queued = true;
+        _hitTestQueue.push_back(entry.listener);
+    }
+}
+
+void EventDispatcher::insertHitTestEntry(HitTestEntry& entry)
+{
+    // the node and its ancestors report their transform changes, see Node::bumpTransformVersion()
+    entry.valid = true;
+    for (Node* node = entry.listener->getAssociatedNode(); node != nullptr; node = node->getParent())
+    {
+        ++node->_hitTestCount;
+    }
+
+    const float x0 = std::floor(entry.bounds.getMinX() / _hitTestCellSize);
+    const float y0 = std::floor(entry.bounds.getMinY() / _hitTestCellSize);
+    const float x1 = std::floor(entry.bounds.getMaxX() / _hitTestCellSize);
+    const float y1 = std::floor(entry.bounds.getMaxY() / _hitTestCellSize);
+
+    // also catches bounds that aren't finite
+    entry.large = !((x1 - x0 + 1) * (y1 - y0 + 1) <= HIT_TEST_MAX_CELLS);
+    if (entry.large)
+    {
+        _hitTestLargeEntries.push_back(entry.listener);
+        return;
+    }
+
+    entry.cellX0 = static_cast<int>(x0);
+    entry.cellY0 = static_cast<int>(y0);
+    entry.cellX1 = static_cast<int>(x1);
+    entry.cellY1 = static_cast<int>(y1);
+    for (int x = entry.cellX0; x <= entry.cellX1; ++x)
+    {
+        for (int y = entry.cellY0; y <= entry.cellY1; ++y)
+        {
+            _hitTestCells[hitTestCellKey(x, y)].push_back(entry.listener);
+        }
+    }
+}
+
+void EventDispatcher::eraseHitTestEntry(HitTestEntry& entry)
+{
+    // entries are erased before their node leaves its parent, see pauseEventListenersForTarget()
+    entry.valid = false;
+    for (Node* node = entry.listener->getAssociatedNode(); node != nullptr; node = node->getParent())
+    {
+        if (--node->_hitTestCount == 0 && node->_hitTestMoved)
+        {
+            // nothing below it is hit tested anymore, and the node may go away
+            node->_hitTestMoved = false;
+            _hitTestMovedNodes.erase(std::find(_hitTestMovedNodes.begin(), _hitTestMovedNodes.end(), node));
+        }
+    }
+
+    if (entry.large)
+    {
+        auto iter = std::find(_hitTestLargeEntries.begin(), _hitTestLargeEntries.end(), entry.listener);
+        *iter = _hitTestLargeEntries.back();
+        _hitTestLargeEntries.pop_back();
+        return;
+    }
+
+    for (int x = entry.cellX0; x <= entry.cellX1; ++x)
+    {
+        for (int y = entry.cellY0; y <= entry.cellY1; ++y)
+        {
+            auto cell = _hitTestCells.find(hitTestCellKey(x, y));
+            auto& listeners = cell->second;
+            auto iter = std::find(listeners.begin(), listeners.end(), entry.listener);
+            *iter = listeners.back();
+            listeners.pop_back();
+            // scrolled content would leave empty cells behind
+            if (listeners.empty())
+            {
+                _hitTestCells.erase(cell);
+            }
+        }
+    }
+}
+
+void EventDispatcher::queueMovedHitTestEntries(Node* node)
+{
+    auto found = _nodeListenersMap.find(node);
+    if (found != _nodeListenersMap.end())
+    {
+        for (auto listener : *found->second)
+        {
+            if (listener->_hitTestIndex >= 0 && _hitTestEntries[listener->_hitTestIndex].valid)
+            {
+                queueHitTestEntry(_hitTestEntries[listener->_hitTestIndex]);
+            }
+        }
+    }
+
+    // only the branches with entries in the grid
+    for (auto child : node->getChildren())
+    {
+        if (child->_hitTestCount > 0)
+        {
+            queueMovedHitTestEntries(child);
+        }
+    }
+}
+
+void EventDispatcher::hitTest(const Vec2& location, EventListener::Type type)
+{
+    // The transform versions are bumped when the transforms are read, which visiting the scene
+    // does every frame, so the bounds follow the transforms as of the last time they were read.
+    if (!_hitTestMovedNodes.empty())
+    {
+        _hitTestVisitedNodes.swap(_hitTestMovedNodes);
+        for (auto node : _hitTestVisitedNodes)
+        {
+            node->_hitTestMoved = false;
+        }
+        for (auto node : _hitTestVisitedNodes)
+        {
+            queueMovedHitTestEntries(node);
+        }
+        _hitTestVisitedNodes.clear();
+    }
+
+    // computing the bounds may bump more transform versions, those nodes wait for the next hit test
+    _hitTestUpdated.swap(_hitTestQueue);
+    for (auto listener : _hitTestUpdated)
+    {
+        auto& entry = _hitTestEntries[listener->_hitTestIndex];
+        entry.queued = false;
+        // paused listeners aren't called, they are queued again once they are resumed
+        if (listener->isPaused())
+        {
+            continue;
+        }
+
+        if (entry.valid)
+        {
+            eraseHitTestEntry(entry);
+        }
+        auto node = listener->getAssociatedNode();
+        if (node->getCameraMask() == static_cast<unsigned short>(CameraFlag::DEFAULT))
+        {
+            entry.bounds = RectApplyAffineTransform(listener->_hitTestBounds(), node->getNodeToWorldAffineTransform());
+        }
+        else
+        {
+            // the location isn't projected through other cameras, the listener is called wherever the pointer is
+            const float infinity = std::numeric_limits<float>::infinity();
+            entry.bounds.setRect(-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), infinity, infinity);
+        }
+        insertHitTestEntry(entry);
+    }
+    _hitTestUpdated.clear();
+
+    _hitTestCandidates.clear();
+    auto cell = _hitTestCells.find(hitTestCellKey(static_cast<int>(std::floor(location.x / _hitTestCellSize)),
+                                                  static_cast<int>(std::floor(location.y / _hitTestCellSize))));
+    if (cell != _hitTestCells.end())
+    {
+        for (auto listener : cell->second)
+        {
+            if (listener->getType() == type && _hitTestEntries[listener->_hitTestIndex].bounds.containsPoint(location))
+            {
+                _hitTestCandidates.push_back(listener);
+            }
+        }
+    }
+
+    for (auto listener : _hitTestLargeEntries)
+    {
+        if (listener->getType() == type && _hitTestEntries[listener->_hitTestIndex].bounds.containsPoint(location))
+        {
+            _hitTestCandidates.push_back(listener);
+        }
+    }
+
+    const auto& entries = _hitTestEntries;
+    std::sort(_hitTestCandidates.begin(), _hitTestCandidates.end(), [&entries](EventListener* l1, EventListener* l2) {
+        return entries[l1->_hitTestIndex].order < entries[l2->_hitTestIndex].order;
+    });
+}
+
+void EventDispatcher::setHitTestCellSize(float cellSize)
+{
+    CCASSERT(cellSize > 0, "The cell size should be positive.");
+
+    // the entries are inserted again by the next hit test
+    for (auto& entry : _hitTestEntries)
+    {
+        if (entry.valid)
+        {
+            eraseHitTestEntry(entry);
+            queueHitTestEntry(entry);
+        }
+    }
+    _hitTestCellSize = cellSize;
+}
+
 void EventDispatcher::addEventListener(EventListener* listener)
 {
     if (_inDispatch == 0)
@@ -552,13 +781,6 @@ void EventDispatcher::debugCheckNodeHasNoEventListenersOnDestruction(Node* node)
         }
     }
     
-    // Check the node priority map
-    for (const auto & keyValuePair : _nodePriorityMap)
-    {
-        CCASSERT(keyValuePair.first != node,
-                 "Node should have no event listeners registered for it upon destruction!");
-    }
-    
     // Check the to be added list
     for (EventListener * listener : _toAddedListeners)
     {
@@ -801,7 +1023,7 @@ void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, c
     }
 }
 
-void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent)
+void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent, bool hitTested)
 {
     bool shouldStopPropagation = false;
     auto fixedPriorityListeners = listeners->getFixedPriorityListeners();
@@ -835,18 +1057,47 @@ void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listene
             // priority == 0, scene graph priority
             
             // first, get all enabled, unPaused and registered listeners
-            std::vector<EventListener*> sceneListeners;
-            for (auto& l : *sceneGraphPriorityListeners)
-            {
+            auto frameArena = Director::getInstance()->getFrameArena();
+            FrameVector<EventListener*> sceneListeners{FrameAllocator<EventListener*>(frameArena)};
+            auto addSceneListener = [&sceneListeners](EventListener* l) {
                 if (l->isEnabled() && !l->isPaused() && l->isRegistered())
                 {
                     sceneListeners.push_back(l);
                 }
+            };
+            if (hitTested)
+            {
+                // the listeners the hit test found, merged with those without bounds in their sorted order
+                const auto& unboundedListeners = listeners->getUnboundedListeners();
+                sceneListeners.reserve(unboundedListeners.size() + _hitTestCandidates.size());
+                auto unbounded = unboundedListeners.begin();
+                for (auto candidate : _hitTestCandidates)
+                {
+                    const ssize_t order = _hitTestEntries[candidate->_hitTestIndex].order;
+                    for (; unbounded != unboundedListeners.end() && unbounded->first < order; ++unbounded)
+                    {
+                        addSceneListener(unbounded->second);
+                    }
+                    addSceneListener(candidate);
+                }
+                for (; unbounded != unboundedListeners.end(); ++unbounded)
+                {
+                    addSceneListener(unbounded->second);
+                }
+            }
+            else
+            {
+                sceneListeners.reserve(sceneGraphPriorityListeners->size());
+                for (auto& l : *sceneGraphPriorityListeners)
+                {
+                    addSceneListener(l);
+                }
             }
             // second, for all camera call all listeners
             // get a copy of cameras, prevent it's been modified in listener callback
             // if camera's depth is greater, process it earlier
-            auto cameras = scene->getCameras();
+            const auto& sceneCameras = scene->getCameras();
+            FrameVector<Camera*> cameras(sceneCameras.begin(), sceneCameras.end(), FrameAllocator<Camera*>(frameArena));
             for (auto rit = cameras.rbegin(), ritRend = cameras.rend(); rit != ritRend; ++rit)
             {
                 Camera* camera = *rit;
@@ -918,9 +1169,14 @@ void EventDispatcher::dispatchEvent(Event* event)
     
     sortEventListeners(listenerID);
     
-    auto pfnDispatchEventToListeners = &EventDispatcher::dispatchEventToListeners;
-    if (event->getType() == Event::Type::MOUSE) {
-        pfnDispatchEventToListeners = &EventDispatcher::dispatchTouchEventToListeners;
+    const bool isMouseEvent = event->getType() == Event::Type::MOUSE;
+    // only presses are hit tested, moves, releases and scrolls reach every listener since drags need them
+    const bool hitTested = isMouseEvent && !_hitTestEntries.empty()
+        && static_cast<EventMouse*>(event)->getMouseEventType() == EventMouse::MouseEventType::MOUSE_DOWN;
+    if (hitTested)
+    {
+        // the cursor position is set in OpenGL coordinates already, see GLViewImpl
+        hitTest(static_cast<EventMouse*>(event)->getLocationInView(), EventListener::Type::MOUSE);
     }
     auto iter = _listenerMap.find(listenerID);
     if (iter != _listenerMap.end())
@@ -933,7 +1189,14 @@ void EventDispatcher::dispatchEvent(Event* event)
             return event->isStopped();
         };
         
-        (this->*pfnDispatchEventToListeners)(listeners, onEvent);
+        if (isMouseEvent)
+        {
+            dispatchTouchEventToListeners(listeners, std::ref(onEvent), hitTested);
+        }
+        else
+        {
+            dispatchEventToListeners(listeners, std::ref(onEvent));
+        }
     }
     
     updateListeners(event);
@@ -980,6 +1243,13 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
         {
             bool isSwallowed = false;
 
+            // only the listeners whose bounds contain a beginning touch are called
+            const bool hitTested = !_hitTestEntries.empty() && event->getEventCode() == EventTouch::EventCode::BEGAN;
+            if (hitTested)
+            {
+                hitTest(touches->getLocation(), EventListener::Type::TOUCH_ONE_BY_ONE);
+            }
+
             auto onTouchEvent = [&](EventListener* l) -> bool { // Return true to break
                 EventListenerTouchOneByOne* listener = static_cast<EventListenerTouchOneByOne*>(l);
                 
@@ -1068,7 +1338,8 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
             };
             
             //
-            dispatchTouchEventToListeners(oneByOneListeners, onTouchEvent);
+            // by reference, the lambda is too large for the small buffer of std::function
+            dispatchTouchEventToListeners(oneByOneListeners, std::ref(onTouchEvent), hitTested);
             if (event->isStopped())
             {
                 return;
@@ -1134,7 +1405,7 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
             return false;
         };
         
-        dispatchTouchEventToListeners(allAtOnceListeners, onTouchesEvent);
+        dispatchTouchEventToListeners(allAtOnceListeners, std::ref(onTouchesEvent));
         if (event->isStopped())
         {
             return;
@@ -1274,6 +1545,20 @@ void EventDispatcher::updateDirtyFlagForSceneGraph()
         
         _dirtyNodes.clear();
     }
+
+    if (_sceneGraphDirty)
+    {
+        for (const auto& e : _listenerMap)
+        {
+            auto sceneGraphListeners = e.second->getSceneGraphPriorityListeners();
+            if (sceneGraphListeners && !sceneGraphListeners->empty())
+            {
+                setDirty(e.first, DirtyFlag::SCENE_GRAPH_PRIORITY);
+            }
+        }
+
+        _sceneGraphDirty = false;
+    }
 }
 
 void EventDispatcher::sortEventListeners(const EventListener::ListenerID& listenerID)
@@ -1322,22 +1607,51 @@ void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener
     if (sceneGraphListeners == nullptr)
         return;
 
-    // Reset priority index
-    _nodePriorityIndex = 0;
-    _nodePriorityMap.clear();
+    // Only the ancestors of the listeners' nodes are visited, not the whole scene graph
+    _nodeOrderKeys.resize(sceneGraphListeners->size());
+    _nodeOrderPaths.clear();
+    for (size_t i = 0; i < sceneGraphListeners->size(); ++i)
+    {
+        auto l = sceneGraphListeners->at(i);
+        _nodeOrderKeys[i].listener = l;
+        computeNodeOrderKey(l->getAssociatedNode(), rootNode, _nodeOrderKeys[i]);
+    }
 
-    visitTarget(rootNode, true);
-    
-    // After sort: priority < 0, > 0
-    std::stable_sort(sceneGraphListeners->begin(), sceneGraphListeners->end(), [this](const EventListener* l1, const EventListener* l2) {
-        return _nodePriorityMap[l1->getAssociatedNode()] > _nodePriorityMap[l2->getAssociatedNode()];
+    // After sort: the node drawn last first
+    const std::int64_t* paths = _nodeOrderPaths.data();
+    std::stable_sort(_nodeOrderKeys.begin(), _nodeOrderKeys.end(), [paths](const NodeOrderKey& k1, const NodeOrderKey& k2) {
+        if (k1.inScene != k2.inScene)
+            return k1.inScene;
+        if (!k1.inScene)
+            return false;
+        if (k1.globalZOrder != k2.globalZOrder)
+            return k1.globalZOrder > k2.globalZOrder;
+        return std::lexicographical_compare(paths + k2.pathBegin, paths + k2.pathEnd, paths + k1.pathBegin, paths + k1.pathEnd);
     });
+
+    // a hit test dispatch merges the listeners it found with the others by their index
+    auto& unboundedListeners = listeners->getUnboundedListeners();
+    unboundedListeners.clear();
+    for (size_t i = 0; i < _nodeOrderKeys.size(); ++i)
+    {
+        auto l = _nodeOrderKeys[i].listener;
+        (*sceneGraphListeners)[i] = l;
+        if (l->_hitTestIndex >= 0)
+        {
+            _hitTestEntries[l->_hitTestIndex].order = static_cast<ssize_t>(i);
+        }
+        else
+        {
+            unboundedListeners.emplace_back(static_cast<ssize_t>(i), l);
+        }
+    }
     
 #if DUMP_LISTENER_ITEM_PRIORITY_INFO
     log("-----------------------------------");
-    for (auto& l : *sceneGraphListeners)
+    for (auto& key : _nodeOrderKeys)
     {
-        log("listener priority: node ([%s]%p), priority (%d)", typeid(*l->_node).name(), l->_node, _nodePriorityMap[l->_node]);
+        log("listener priority: node ([%s]%p), global z (%f), depth (%d)", typeid(*key.listener->_node).name(), key.listener->_node,
+            key.globalZOrder, (int)(key.pathEnd - key.pathBegin - 1));
     }
 #endif
 }
@@ -1535,11 +1849,11 @@ void EventDispatcher::setDirtyForNode(Node* node)
         _dirtyNodes.insert(node);
     }
 
-    // Also set the dirty flag for node's children
-    const auto& children = node->getChildren();
-    for (const auto& child : children)
+    // The listeners of its descendants are ordered through its position too. Marking the scene graph
+    // listener IDs dirty is cheaper than walking the subtree, since sorting doesn't walk the scene graph.
+    if (!node->getChildren().empty())
     {
-        setDirtyForNode(child);
+        _sceneGraphDirty = true;
     }
 }
 
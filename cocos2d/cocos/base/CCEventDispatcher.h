@@ -26,6 +26,7 @@
 #ifndef __CC_EVENT_DISPATCHER_H__
 #define __CC_EVENT_DISPATCHER_H__
 
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <unordered_map>
@@ -161,6 +162,15 @@ public:
      */
     bool isEnabled() const;
 
+    /** Sets the size of the cells of the grid holding the listeners with hit test bounds, in world space.
+     *
+     * @param cellSize The size of a cell, about the size of the smallest hit tested nodes. 64 by default.
+     */
+    void setHitTestCellSize(float cellSize);
+
+    /** Gets the size of the cells of the hit test grid. */
+    float getHitTestCellSize() const { return _hitTestCellSize; }
+
     /////////////////////////////////////////////
     
     /** Dispatches the event.
@@ -231,10 +241,13 @@ protected:
         std::vector<EventListener*>* getSceneGraphPriorityListeners() const { return _sceneGraphListeners; }
         ssize_t getGt0Index() const { return _gt0Index; }
         void setGt0Index(ssize_t index) { _gt0Index = index; }
+        /** The scene graph priority listeners without hit test bounds and their index, as of the last sort */
+        std::vector<std::pair<ssize_t, EventListener*>>& getUnboundedListeners() { return _unboundedListeners; }
     private:
         std::vector<EventListener*>* _fixedListeners;
         std::vector<EventListener*>* _sceneGraphListeners;
         ssize_t _gt0Index;
+        std::vector<std::pair<ssize_t, EventListener*>> _unboundedListeners;
     };
     
     /** Adds an event listener with item
@@ -292,8 +305,10 @@ protected:
      *      order by viewport/camera first, because the touch location convert
      *      to 3D world space is different by different camera.
      *  When listener process touch event, can get current camera by Camera::getVisitingCamera().
+     *  When hitTested is true, only the scene graph priority listeners found by the last hitTest()
+     *  and those without hit test bounds are called.
      */
-    void dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent);
+    void dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent, bool hitTested = false);
     
     void releaseListener(EventListener* listener);
     
@@ -309,8 +324,51 @@ protected:
     /** Sets the dirty flag for a specified listener ID */
     void setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag);
     
-    /** Walks though scene graph to get the draw order for each node, it's called before sorting event listener with scene graph priority */
-    void visitTarget(Node* node, bool isRootNode);
+    /** The position of a scene graph priority listener's node in the draw order, computed from the node's ancestors. */
+    struct NodeOrderKey
+    {
+        EventListener* listener;
+        /** Nodes out of the running scene come first, as if they were drawn before the scene */
+        bool inScene;
+        float globalZOrder;
+        /** The range of _nodeOrderPaths holding the path from the scene to the node */
+        size_t pathBegin;
+        size_t pathEnd;
+    };
+
+    /** Computes the draw order key of a node, walking up to the scene only. */
+    void computeNodeOrderKey(Node* node, Node* rootNode, NodeOrderKey& key);
+
+    /** A listener with hit test bounds, and where its bounds are in the grid */
+    struct HitTestEntry
+    {
+        EventListener* listener;
+        /** Whether the bounds are in the grid, and counted by the node and its ancestors */
+        bool valid;
+        /** Whether the entry is in _hitTestQueue */
+        bool queued;
+        /** The index of the listener in its sorted scene graph priority listeners */
+        ssize_t order;
+        /** The bounds in world space */
+        Rect bounds;
+        /** The cells covered by the bounds, or none if the entry is in _hitTestLargeEntries */
+        int cellX0, cellY0, cellX1, cellY1;
+        bool large;
+    };
+
+    void addHitTestEntry(EventListener* listener);
+    void removeHitTestEntry(EventListener* listener);
+    void queueHitTestEntry(HitTestEntry& entry);
+    void insertHitTestEntry(HitTestEntry& entry);
+    void eraseHitTestEntry(HitTestEntry& entry);
+
+    /** Queues the valid entries at or below a node that moved */
+    void queueMovedHitTestEntries(Node* node);
+
+    /** Updates the queued bounds and those below the moved nodes, then collects the listeners
+     *  of a type whose bounds contain the location into _hitTestCandidates, in their listeners' order
+     */
+    void hitTest(const Vec2& location, EventListener::Type type);
 
     /** Remove all listeners in _toRemoveListeners list and cleanup */
     void cleanToRemovedListeners();
@@ -324,11 +382,11 @@ protected:
     /** The map of node and event listeners */
     std::unordered_map<Node*, std::vector<EventListener*>*> _nodeListenersMap;
     
-    /** The map of node and its event priority */
-    std::unordered_map<Node*, int> _nodePriorityMap;
+    /** The order keys of the listeners being sorted, reused between sorts */
+    std::vector<NodeOrderKey> _nodeOrderKeys;
     
-    /** key: Global Z Order, value: Sorted Nodes */
-    std::unordered_map<float, std::vector<Node*>> _globalZOrderNodeMap;
+    /** The local z orders and orders of arrival of the nodes on the paths of _nodeOrderKeys */
+    std::vector<std::int64_t> _nodeOrderPaths;
     
     /** The listeners to be added after dispatching event */
     std::vector<EventListener*> _toAddedListeners;
@@ -345,7 +403,23 @@ protected:
     /** Whether to enable dispatching event */
     bool _isEnabled;
     
-    int _nodePriorityIndex;
+    /** Whether a node with children moved, which moves the listeners of its descendants too */
+    bool _sceneGraphDirty;
+
+    /** The listeners with hit test bounds, and the grid of world space cells they cover */
+    std::vector<HitTestEntry> _hitTestEntries;
+    std::unordered_map<std::int64_t, std::vector<EventListener*>> _hitTestCells;
+    /** The listeners whose bounds cover too many cells, tested one by one */
+    std::vector<EventListener*> _hitTestLargeEntries;
+    /** The nodes with valid entries below them whose transform version was bumped, see Node::bumpTransformVersion() */
+    std::vector<Node*> _hitTestMovedNodes;
+    /** The listeners whose bounds are computed again by the next hit test */
+    std::vector<EventListener*> _hitTestQueue;
+    /** The listeners found by the last hit test */
+    std::vector<EventListener*> _hitTestCandidates;
+    std::vector<Node*> _hitTestVisitedNodes;
+    std::vector<EventListener*> _hitTestUpdated;
+    float _hitTestCellSize;
     
     std::set<std::string> _internalCustomListenerIDs;
 };
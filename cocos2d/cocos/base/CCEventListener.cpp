@@ -44,10 +44,17 @@ bool EventListener::init(Type t, const ListenerID& listenerID, const std::functi
     _isRegistered = false;
     _paused = false;
     _isEnabled = true;
+    _hitTestIndex = -1;
     
     return true;
 }
 
+void EventListener::setHitTestBounds(const std::function<Rect()>& bounds)
+{
+    CCASSERT(!_isRegistered, "The hit test bounds must be set before the listener is added.");
+    _hitTestBounds = bounds;
+}
+
 bool EventListener::checkAvailable()
 { 
 	return (_onEvent != nullptr);
@@ -32,6 +32,7 @@
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCRef.h"
+#include "math/CCGeometry.h"
 
 /**
  * @addtogroup base
@@ -111,6 +112,23 @@ public:
      */
     bool isEnabled() const { return _isEnabled; }
 
+    /** Sets the bounds hit tested by EventDispatcher before calling the listener.
+     * @note Only used by scene graph priority EventListenerTouchOneByOne and EventListenerMouse listeners.
+     *        A touch that begins, or a mouse button pressed, outside the bounds is not sent to the listener. The other
+     *        touch and mouse events are sent as usual, so drags and releases outside the bounds still arrive.
+     *        The dispatcher keeps the bounds in a grid in world space, so it only calls the listeners under the pointer.
+     *        The bounds are computed again when a transform from the scene to the node changes. It has to be set
+     *        before the listener is added.
+     *        The pointer location isn't projected through the cameras: the bounds of a node whose camera mask isn't
+     *        CameraFlag::DEFAULT are not tested, and its listener gets the events wherever they happen.
+     *
+     * @param bounds Returns the bounds in the space of the listener's node, e.g. `Rect(Vec2::ZERO, node->getContentSize())`.
+     */
+    void setHitTestBounds(const std::function<Rect()>& bounds);
+
+    /** Gets the provider of the hit tested bounds, empty if the listener isn't hit tested by the dispatcher. */
+    const std::function<Rect()>& getHitTestBounds() const { return _hitTestBounds; }
+
 protected:
 
     /** Sets paused state for the listener
@@ -174,6 +192,9 @@ protected:
     Node* _node;            // scene graph based priority
     bool _paused;           // Whether the listener is paused
     bool _isEnabled;        // Whether the listener is enabled
+
+    std::function<Rect()> _hitTestBounds;   // The bounds hit tested by the dispatcher, in the node's space
+    int _hitTestIndex;                      // The entry of the listener in the dispatcher's hit test grid, -1 if none
     friend class EventDispatcher;
 };
 
@@ -59,6 +59,7 @@ EventListenerMouse* EventListenerMouse::clone()
         ret->onMouseDown = onMouseDown;
         ret->onMouseMove = onMouseMove;
         ret->onMouseScroll = onMouseScroll;
+        ret->_hitTestBounds = _hitTestBounds;
     }
     else
     {
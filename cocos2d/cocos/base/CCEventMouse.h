@@ -77,6 +77,12 @@ public:
      */
     EventMouse(MouseEventType mouseEventCode);
 
+    /** Get the type of the mouse event.
+     *
+     * @return The type of the mouse event.
+     */
+    MouseEventType getMouseEventType() const { return _mouseEventType; }
+
     /** Set mouse scroll data.
      * 
      * @param scrollX The scroll data of x axis.
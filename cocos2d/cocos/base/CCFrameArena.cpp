@@ -0,0 +1,127 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCFrameArena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+
+NS_CC_BEGIN
+
+FrameArena::FrameArena(size_t chunkSize)
+: _chunkSize(chunkSize)
+, _offset(0)
+, _fullChunksSize(0)
+, _frameBytes(0)
+, _frameAllocations(0)
+, _lastFrameBytes(0)
+, _lastFrameAllocations(0)
+, _peakFrameBytes(0)
+, _heapAllocations(0)
+{
+}
+
+FrameArena::~FrameArena()
+{
+    for (auto& chunk : _chunks)
+    {
+        free(chunk.data);
+    }
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    ++_frameAllocations;
+    _frameBytes += size;
+
+    if (!_chunks.empty())
+    {
+        const Chunk& chunk = _chunks.back();
+        const uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+        const size_t offset = ((base + _offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+        if (offset + size <= chunk.size)
+        {
+            _offset = offset + size;
+            return chunk.data + offset;
+        }
+    }
+
+    addChunk(std::max(_chunkSize, size + alignment));
+
+    const Chunk& chunk = _chunks.back();
+    const uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data);
+    const size_t offset = ((base + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+    _offset = offset + size;
+    return chunk.data + offset;
+}
+
+void FrameArena::deallocate(void* address, size_t size)
+{
+    if (!_chunks.empty() && static_cast<char*>(address) + size == _chunks.back().data + _offset)
+    {
+        _offset = static_cast<char*>(address) - _chunks.back().data;
+    }
+}
+
+void FrameArena::reset()
+{
+    _lastFrameBytes = _frameBytes;
+    _lastFrameAllocations = _frameAllocations;
+    _peakFrameBytes = std::max(_peakFrameBytes, _frameBytes);
+    _frameBytes = 0;
+    _frameAllocations = 0;
+    _offset = 0;
+
+    // the next frame likely needs as much, so it gets a single chunk that size
+    if (_chunks.size() > 1)
+    {
+        const size_t size = _fullChunksSize + _chunks.back().size;
+        for (auto& chunk : _chunks)
+        {
+            free(chunk.data);
+        }
+        _chunks.clear();
+        _fullChunksSize = 0;
+        addChunk(size);
+    }
+}
+
+void FrameArena::addChunk(size_t size)
+{
+    if (!_chunks.empty())
+    {
+        _fullChunksSize += _chunks.back().size;
+    }
+
+    Chunk chunk;
+    chunk.data = static_cast<char*>(malloc(size));
+    chunk.size = size;
+    _chunks.push_back(chunk);
+    _offset = 0;
+    ++_heapAllocations;
+}
+
+NS_CC_END
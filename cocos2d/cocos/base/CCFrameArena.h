@@ -0,0 +1,173 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCFRAME_ARENA_H_
+#define __CCFRAME_ARENA_H_
+
+#include "platform/CCPlatformMacros.h"
+#include <cstddef>
+#include <vector>
+
+/**
+* @addtogroup base
+* @{
+*/
+NS_CC_BEGIN
+
+/**
+ * @class FrameArena
+ * @brief A bump allocator for temporaries that don't outlive the frame.
+ *
+ * Allocating only moves a pointer, and nothing is freed before reset(), which Director calls once the
+ * frame is rendered. The memory of a frame that needed several chunks is merged into one chunk at reset,
+ * so that a steady frame ends up allocating nothing from the heap.
+ * A FrameArena can only be used from the cocos thread, the one of Director::getFrameArena() at least.
+ * @js NA
+ */
+class CC_DLL FrameArena
+{
+public:
+    /**
+     * @param chunkSize The size of the first chunk, and the least size of the chunks added when it is full.
+     */
+    explicit FrameArena(size_t chunkSize = 64 * 1024);
+    ~FrameArena();
+
+    /**
+     * Allocates memory that stays valid until the next reset().
+     *
+     * @param size The number of bytes.
+     * @param alignment The alignment of the memory, a power of 2.
+     * @return The memory.
+     */
+    void* allocate(size_t size, size_t alignment = 16);
+
+    /**
+     * Allocates an array of count T that stays valid until the next reset(). The objects are not constructed.
+     */
+    template <typename T>
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * Gives back memory when it is the last allocation, which lets a growing container reuse it.
+     * Does nothing otherwise.
+     */
+    void deallocate(void* address, size_t size);
+
+    /**
+     * Frees every allocation at once and starts counting a new frame.
+     */
+    void reset();
+
+    /** Gets the number of bytes allocated since the last reset. */
+    size_t getFrameBytes() const { return _frameBytes; }
+
+    /** Gets the number of allocations since the last reset, each one a heap allocation avoided. */
+    size_t getFrameAllocations() const { return _frameAllocations; }
+
+    /** Gets the number of bytes allocated during the last frame. */
+    size_t getLastFrameBytes() const { return _lastFrameBytes; }
+
+    /** Gets the number of allocations made during the last frame. */
+    size_t getLastFrameAllocations() const { return _lastFrameAllocations; }
+
+    /** Gets the largest number of bytes allocated in a frame. */
+    size_t getPeakFrameBytes() const { return _peakFrameBytes; }
+
+    /** Gets the number of chunks the arena allocated from the heap since it was created. */
+    size_t getHeapAllocations() const { return _heapAllocations; }
+
+private:
+    struct Chunk
+    {
+        char* data;
+        size_t size;
+    };
+
+    void addChunk(size_t size);
+
+    std::vector<Chunk> _chunks;
+    size_t _chunkSize;
+    /** The first free byte of the last chunk */
+    size_t _offset;
+    /** The bytes of the chunks before the last one */
+    size_t _fullChunksSize;
+
+    size_t _frameBytes;
+    size_t _frameAllocations;
+    size_t _lastFrameBytes;
+    size_t _lastFrameAllocations;
+    size_t _peakFrameBytes;
+    size_t _heapAllocations;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(FrameArena);
+};
+
+/**
+ * @class FrameAllocator
+ * @brief An STL allocator taking its memory from a FrameArena, for containers that are local to a frame.
+ * @js NA
+ */
+template <typename T>
+class FrameAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit FrameAllocator(FrameArena* arena) : _arena(arena) {}
+
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>& other) : _arena(other._arena) {}
+
+    T* allocate(size_t count)
+    {
+        return _arena->allocate<T>(count);
+    }
+
+    void deallocate(T* address, size_t count)
+    {
+        _arena->deallocate(address, sizeof(T) * count);
+    }
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>& other) const { return _arena == other._arena; }
+
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>& other) const { return _arena != other._arena; }
+
+    FrameArena* _arena;
+};
+
+/** A vector local to a frame, e.g. `FrameVector<Node*> nodes(FrameAllocator<Node*>(Director::getInstance()->getFrameArena()));` */
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CCFRAME_ARENA_H_
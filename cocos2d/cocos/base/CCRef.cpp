@@ -91,19 +91,30 @@ Ref::~Ref()
 void Ref::retain()
 {
     CCASSERT(_referenceCount > 0, "reference count should be greater than 0");
+#if CC_ENABLE_ATOMIC_REF_COUNT
+    // a new reference is always made from an existing one, so no ordering is needed
+    _referenceCount.fetch_add(1, std::memory_order_relaxed);
+#else
     ++_referenceCount;
+#endif
 }
 
 void Ref::release()
 {
     CCASSERT(_referenceCount > 0, "reference count should be greater than 0");
-    --_referenceCount;
+#if CC_ENABLE_ATOMIC_REF_COUNT
+    // the thread dropping the last reference must see every write made through the others
+    const bool last = _referenceCount.fetch_sub(1, std::memory_order_acq_rel) == 1;
+#else
+    const bool last = --_referenceCount == 0;
+#endif
 
-    if (_referenceCount == 0)
+    if (last)
     {
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
         auto poolManager = PoolManager::getInstance();
-        if (!poolManager->getCurrentPool()->isClearing() && poolManager->isObjectInPools(this))
+        // the pools belong to the cocos thread, they can't be looked into from a worker
+        if (poolManager->isCocosThread() && !poolManager->getCurrentPool()->isClearing() && poolManager->isObjectInPools(this))
         {
             // Trigger an assert if the reference count is 0 but the Ref is still in autorelease pool.
             // This happens when 'autorelease/release' were not used in pairs with 'new/retain'.
@@ -153,7 +164,15 @@ void Ref::release()
 
 Ref* Ref::autorelease()
 {
-    PoolManager::getInstance()->getCurrentPool()->addObject(this);
+    auto poolManager = PoolManager::getInstance();
+#if CC_ENABLE_ATOMIC_REF_COUNT
+    if (!poolManager->isCocosThread())
+    {
+        poolManager->addThreadRelease(this);
+        return this;
+    }
+#endif
+    poolManager->getCurrentPool()->addObject(this);
     return this;
 }
 
@@ -30,6 +30,10 @@ THE SOFTWARE.
 #include "platform/CCPlatformMacros.h"
 #include "base/ccConfig.h"
 
+#if CC_ENABLE_ATOMIC_REF_COUNT
+#include <atomic>
+#endif
+
 #define CC_REF_LEAK_DETECTION 0
 
 /**
@@ -109,6 +113,14 @@ public:
      * If the reference count reaches 0 after the decrement, this Ref is
      * destructed.
      *
+     * With CC_ENABLE_ATOMIC_REF_COUNT, calling it off the cocos thread keeps the
+     * object in a list private to the calling thread instead. The cocos thread releases
+     * it at the end of the first frame after PoolManager::flushThreadReleases() is
+     * called on that thread, so retain the object before flushing if it has to outlive
+     * that release. A release() that drops the last reference on a worker destroys the
+     * object on the worker; use PoolManager::deferRelease() for objects that must be
+     * destroyed on the cocos thread.
+     *
      * @returns The Ref itself.
      *
      * @see AutoreleasePool, retain, release
@@ -145,7 +157,18 @@ public:
 
 protected:
     /// count of references
+#if CC_ENABLE_ATOMIC_REF_COUNT
+    // Copies like the plain unsigned int it replaces, so Ref subclasses keep their copy constructors.
+    struct AtomicCount : std::atomic<unsigned int>
+    {
+        AtomicCount(unsigned int count) : std::atomic<unsigned int>(count) {}
+        AtomicCount(const AtomicCount& other) : std::atomic<unsigned int>(other.load(std::memory_order_relaxed)) {}
+        AtomicCount& operator=(const AtomicCount& other) { store(other.load(std::memory_order_relaxed), std::memory_order_relaxed); return *this; }
+    };
+    AtomicCount _referenceCount;
+#else
     unsigned int _referenceCount;
+#endif
 
     friend class AutoreleasePool;
 
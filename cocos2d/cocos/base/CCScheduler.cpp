@@ -29,44 +29,13 @@ THE SOFTWARE.
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
-#include "base/utlist.h"
-#include "base/ccCArray.h"
 #include "base/CCScriptSupport.h"
 
-NS_CC_BEGIN
-
-// data structures
-
-// A list double-linked list used for "updates with priority"
-typedef struct _listEntry
-{
-    struct _listEntry   *prev, *next;
-    ccSchedulerFunc     callback;
-    void                *target;
-    int                 priority;
-    bool                paused;
-    bool                markedForDeletion; // selector will no longer be called and entry will be removed at end of the next tick
-} tListEntry;
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 
-typedef struct _hashUpdateEntry
-{
-    tListEntry          **list;        // Which list does it belong to ?
-    tListEntry          *entry;        // entry in the list
-    void                *target;
-    ccSchedulerFunc     callback;
-    UT_hash_handle      hh;
-} tHashUpdateEntry;
-
-// Hash Element used for "selectors with interval"
-typedef struct _hashSelectorEntry
-{
-    ccArray             *timers;
-    void                *target;
-    int                 timerIndex;
-    Timer               *currentTimer;
-    bool                paused;
-    UT_hash_handle      hh;
-} tHashTimerEntry;
+NS_CC_BEGIN
 
 // implementation Timer
 
@@ -80,6 +49,11 @@ Timer::Timer()
 , _delay(0.0f)
 , _interval(0.0f)
 , _aborted(false)
+, _nextFireTime(0.0)
+, _lastFireTime(0.0)
+, _heapIndex(-1)
+, _starting(false)
+, _firing(false)
 {
 }
 
@@ -151,6 +125,75 @@ bool Timer::isExhausted() const
     return !_runForever && _timesExecuted > _repeat;
 }
 
+void Timer::start(double time)
+{
+    _elapsed = 0;
+    _timesExecuted = 0;
+    _lastFireTime = time;
+    _nextFireTime = time + (_useDelay ? _delay : _interval);
+}
+
+void Timer::fire(double time)
+{
+    // deal with delay
+    if (_useDelay)
+    {
+        _timesExecuted += 1; // important to increment before call trigger
+        trigger(_delay);
+        // rescheduled from the callback: keep the new delay, start() sets the fire times
+        if (_aborted || _starting)
+        {
+            return;
+        }
+        _useDelay = false;
+        _lastFireTime = _nextFireTime;
+        _nextFireTime += _interval;
+        if (isExhausted())
+        {    //unschedule timer
+            cancel();
+            return;
+        }
+        // after delay, a timer without interval waits for the next frame
+        if (_interval <= 0)
+        {
+            return;
+        }
+    }
+
+    // if _interval == 0, should trigger once every frame
+    if (_interval <= 0)
+    {
+        _timesExecuted += 1;
+        trigger(static_cast<float>(time - _lastFireTime));
+        _lastFireTime = _nextFireTime = time;
+        if (!_aborted && !_starting && isExhausted())
+        {
+            cancel();
+        }
+        return;
+    }
+
+    while (_nextFireTime <= time && !_aborted && !_starting)
+    {
+        _timesExecuted += 1; // important to increment before call trigger
+        trigger(_interval);
+        _lastFireTime = _nextFireTime;
+        _nextFireTime += _interval;
+
+        if (!_aborted && !_starting && isExhausted())
+        {
+            cancel();
+            break;
+        }
+    }
+}
+
+void Timer::shift(double offset)
+{
+    _nextFireTime += offset;
+    _lastFireTime += offset;
+}
+
 // TimerTargetSelector
 
 TimerTargetSelector::TimerTargetSelector()
@@ -212,6 +255,35 @@ void TimerTargetCallback::cancel()
     _scheduler->unschedule(_key, _target);
 }
 
+// TimerTargetInline
+
+TimerTargetInline::TimerTargetInline()
+: _invoke(nullptr)
+, _destroy(nullptr)
+{
+}
+
+TimerTargetInline::~TimerTargetInline()
+{
+    if (_destroy)
+    {
+        _destroy(_storage);
+    }
+}
+
+void TimerTargetInline::trigger(float dt)
+{
+    if (_invoke)
+    {
+        _invoke(_storage, dt);
+    }
+}
+
+void TimerTargetInline::cancel()
+{
+    // kept by the scheduler so that it can be rearmed
+}
+
 #if CC_ENABLE_SCRIPT_BINDING
 
 // TimerScriptHandler
@@ -250,87 +322,348 @@ const int Scheduler::PRIORITY_SYSTEM = INT_MIN;
 // Minimum priority level for user scheduling.
 const int Scheduler::PRIORITY_NON_SYSTEM_MIN = PRIORITY_SYSTEM + 1;
 
+// Nodes of performFunctionInCocosThread() kept in the pool, more are allocated during bursts.
+static const unsigned int PERFORM_POOL_SIZE = 256;
+
+struct Scheduler::PerformNode
+{
+    std::atomic<PerformNode*> next;
+    std::atomic<unsigned int> nextFree; // pool index + 1 of the next free node
+    unsigned long long sequence;
+    std::function<void()> function;
+    bool pooled;
+};
+
 Scheduler::Scheduler(void)
 : _timeScale(1.0f)
-, _updatesNegList(nullptr)
-, _updates0List(nullptr)
-, _updatesPosList(nullptr)
-, _hashForUpdates(nullptr)
-, _hashForTimers(nullptr)
-, _currentTarget(nullptr)
-, _currentTargetSalvaged(false)
-, _updateHashLocked(false)
+, _updateTombstones(0)
+, _timerTime(0.0)
+, _timerOrder(0)
+, _updateLocked(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
+, _performPool(nullptr)
+, _performFreeNodes(0)
+, _performTail(nullptr)
+, _performHead(nullptr)
+, _performSequence(0)
+, _performDiscardBefore(0)
+, _performBudget(0.0f)
 {
-    // I don't expect to have more than 30 functions to all per frame
-    _functionsToPerform.reserve(30);
+    // the first node is the empty head of the queue, the others are free
+    _performPool = new PerformNode[PERFORM_POOL_SIZE];
+    for (unsigned int i = 0; i < PERFORM_POOL_SIZE; ++i)
+    {
+        _performPool[i].next.store(nullptr, std::memory_order_relaxed);
+        _performPool[i].nextFree.store(i + 1 < PERFORM_POOL_SIZE ? i + 2 : 0, std::memory_order_relaxed);
+        _performPool[i].sequence = 0;
+        _performPool[i].pooled = true;
+    }
+    _performFreeNodes.store(2, std::memory_order_relaxed);
+    _performHead = &_performPool[0];
+    _performTail.store(_performHead, std::memory_order_release);
 }
 
 Scheduler::~Scheduler(void)
 {
     unscheduleAll();
+
+    for (auto& slot : _startingTimers)
+    {
+        slot.timer->release();
+    }
+    for (auto& slot : _timerHandles)
+    {
+        CC_SAFE_RELEASE(slot.timer);
+    }
+
+    // no thread may queue functions anymore
+    PerformNode *next = nullptr;
+    while ((next = _performHead->next.load(std::memory_order_acquire)) != nullptr)
+    {
+        recyclePerformNode(_performHead);
+        _performHead = next;
+    }
+    if (!_performHead->pooled)
+    {
+        delete _performHead;
+    }
+    delete [] _performPool;
 }
 
-void Scheduler::removeHashElement(_hashSelectorEntry *element)
+Scheduler::TimerTarget& Scheduler::getTimerTarget(void *target, bool paused)
 {
-    ccArrayFree(element->timers);
-    HASH_DEL(_hashForTimers, element);
-    free(element);
+    auto iter = _timerTargets.find(target);
+    if (iter != _timerTargets.end())
+    {
+        CCASSERT(iter->second.paused == paused, "element's paused should be paused!");
+        return iter->second;
+    }
+
+    // Is this the 1st element ? Then set the pause level to all the selectors of this target
+    TimerTarget& timerTarget = _timerTargets[target];
+    timerTarget.paused = paused;
+    timerTarget.pausedTime = _timerTime;
+    return timerTarget;
 }
 
-void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key)
+void Scheduler::addTimer(TimerTarget& timerTarget, Timer *timer, void *target)
 {
-    this->schedule(callback, target, interval, CC_REPEAT_FOREVER, 0.0f, paused, key);
+    timer->retain();
+    timerTarget.timers.push_back(timer);
+    restartTimer(timer, target);
 }
 
-void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused, const std::string& key)
+void Scheduler::restartTimer(Timer *timer, void *target)
 {
-    CCASSERT(target, "Argument target must be non-nullptr");
-    CCASSERT(!key.empty(), "key should not be empty!");
+    if (timer->_heapIndex >= 0)
+    {
+        removeTimerFromHeap(timer);
+    }
+
+    // started at the end of the update, like the first Timer::update() that only resets the elapsed time
+    if (!timer->_starting)
+    {
+        timer->_starting = true;
+        timer->retain();
+        _startingTimers.push_back({ 0.0, 0, timer, target });
+    }
+}
 
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+void Scheduler::dequeueTimer(Timer *timer)
+{
+    // the starting and due lists keep their own reference and skip aborted timers
+    timer->setAborted();
+    if (timer->_heapIndex >= 0)
+    {
+        removeTimerFromHeap(timer);
+    }
+}
 
-    if (! element)
+void Scheduler::pauseTimers(TimerTarget& timerTarget)
+{
+    if (timerTarget.paused)
     {
-        element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
-        element->target = target;
+        return;
+    }
 
-        HASH_ADD_PTR(_hashForTimers, target, element);
+    timerTarget.paused = true;
+    timerTarget.pausedTime = _timerTime;
+    for (auto timer : timerTarget.timers)
+    {
+        if (timer->_heapIndex >= 0)
+        {
+            removeTimerFromHeap(timer);
+        }
+    }
+}
 
-        // Is this the 1st element ? Then set the pause level to all the selectors of this target
-        element->paused = paused;
+void Scheduler::resumeTimers(TimerTarget& timerTarget, void *target)
+{
+    if (!timerTarget.paused)
+    {
+        return;
+    }
+
+    timerTarget.paused = false;
+    const double pausedFor = _timerTime - timerTarget.pausedTime;
+    for (auto timer : timerTarget.timers)
+    {
+        // starting and firing timers are queued by update() itself
+        if (timer->_heapIndex < 0 && !timer->_starting && !timer->_firing
+            && !timer->isAborted() && !timer->isExhausted())
+        {
+            timer->shift(pausedFor);
+            pushTimer(timer, target);
+        }
+    }
+}
+
+void Scheduler::pushTimer(Timer *timer, void *target)
+{
+    timer->_heapIndex = _timerHeap.size();
+    _timerHeap.push_back({ timer->_nextFireTime, _timerOrder++, timer, target });
+    siftTimerUp(_timerHeap.size() - 1);
+}
+
+void Scheduler::removeTimerFromHeap(Timer *timer)
+{
+    const size_t index = timer->_heapIndex;
+    const size_t last = _timerHeap.size() - 1;
+    timer->_heapIndex = -1;
+
+    if (index != last)
+    {
+        _timerHeap[index] = _timerHeap[last];
+        _timerHeap[index].timer->_heapIndex = index;
+        _timerHeap.pop_back();
+        siftTimerDown(index);
+        siftTimerUp(index);
     }
     else
     {
-        CCASSERT(element->paused == paused, "element's paused should be paused!");
+        _timerHeap.pop_back();
+    }
+}
+
+void Scheduler::siftTimerUp(size_t index)
+{
+    const TimerSlot slot = _timerHeap[index];
+    while (index > 0)
+    {
+        const size_t parent = (index - 1) / 2;
+        if (!(slot < _timerHeap[parent]))
+        {
+            break;
+        }
+        _timerHeap[index] = _timerHeap[parent];
+        _timerHeap[index].timer->_heapIndex = index;
+        index = parent;
+    }
+    _timerHeap[index] = slot;
+    slot.timer->_heapIndex = index;
+}
+
+void Scheduler::siftTimerDown(size_t index)
+{
+    const TimerSlot slot = _timerHeap[index];
+    const size_t count = _timerHeap.size();
+    while (true)
+    {
+        size_t child = index * 2 + 1;
+        if (child >= count)
+        {
+            break;
+        }
+        if (child + 1 < count && _timerHeap[child + 1] < _timerHeap[child])
+        {
+            ++child;
+        }
+        if (!(_timerHeap[child] < slot))
+        {
+            break;
+        }
+        _timerHeap[index] = _timerHeap[child];
+        _timerHeap[index].timer->_heapIndex = index;
+        index = child;
     }
+    _timerHeap[index] = slot;
+    slot.timer->_heapIndex = index;
+}
 
-    if (element->timers == nullptr)
+void Scheduler::fireDueTimers()
+{
+    // Take every due timer out of the heap first, callbacks are then free to schedule and unschedule.
+    while (!_timerHeap.empty() && _timerHeap.front().fireTime <= _timerTime)
     {
-        element->timers = ccArrayNew(10);
+        TimerSlot slot = _timerHeap.front();
+        removeTimerFromHeap(slot.timer);
+        slot.timer->_firing = true;
+        slot.timer->retain();
+        _dueTimers.push_back(slot);
     }
-    else 
+
+    for (size_t i = 0; i < _dueTimers.size(); ++i)
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        Timer *timer = _dueTimers[i].timer;
+        void *target = _dueTimers[i].target;
+
+        auto iter = _timerTargets.find(target);
+        if (!timer->isAborted() && iter != _timerTargets.end() && !iter->second.paused)
         {
-            TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
+            timer->fire(_timerTime);
+        }
+        timer->_firing = false;
+        // a timer rearmed from its own callback waits for the whole new delay
+        CCASSERT(!timer->_starting || timer->_useDelay == (timer->_delay > 0.0f),
+                 "rescheduling from the callback must keep the new delay");
 
-            if (timer && !timer->isExhausted() && key == timer->getKey())
+        if (!timer->isAborted() && !timer->_starting && !timer->isExhausted())
+        {
+            // a target paused meanwhile queues its timers again in resumeTarget()
+            iter = _timerTargets.find(target);
+            if (iter != _timerTargets.end() && !iter->second.paused)
             {
-                CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
-                timer->setupTimerWithInterval(interval, repeat, delay);
-                return;
+                pushTimer(timer, target);
             }
         }
-        ccArrayEnsureExtraCapacity(element->timers, 1);
+
+        // The timer may have removed itself. To prevent it from accidentally deallocating
+        // before finishing its step, it was retained. Now that step is done, it's safe to release it.
+        timer->release();
+    }
+    _dueTimers.clear();
+}
+
+void Scheduler::startTimers()
+{
+    if (_startingTimers.empty())
+    {
+        return;
+    }
+
+    // releasing an aborted timer may schedule new ones, they wait for the next update
+    std::vector<TimerSlot> startingTimers;
+    startingTimers.swap(_startingTimers);
+
+    for (auto& slot : startingTimers)
+    {
+        Timer *timer = slot.timer;
+        timer->_starting = false;
+
+        auto iter = _timerTargets.find(slot.target);
+        if (!timer->isAborted() && !timer->isExhausted() && iter != _timerTargets.end())
+        {
+            if (iter->second.paused)
+            {
+                // counts from the pause, resumeTimers() moves it to the resume time
+                timer->start(iter->second.pausedTime);
+            }
+            else
+            {
+                timer->start(_timerTime);
+                pushTimer(timer, slot.target);
+            }
+        }
+        timer->release();
+    }
+
+    startingTimers.clear();
+    if (_startingTimers.empty())
+    {
+        _startingTimers.swap(startingTimers);
+    }
+}
+
+void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key)
+{
+    this->schedule(callback, target, interval, CC_REPEAT_FOREVER, 0.0f, paused, key);
+}
+
+void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused, const std::string& key)
+{
+    CCASSERT(target, "Argument target must be non-nullptr");
+    CCASSERT(!key.empty(), "key should not be empty!");
+
+    TimerTarget& timerTarget = getTimerTarget(target, paused);
+
+    for (auto element : timerTarget.timers)
+    {
+        TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element);
+
+        if (timer && !timer->isExhausted() && key == timer->getKey())
+        {
+            CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
+            timer->setupTimerWithInterval(interval, repeat, delay);
+            restartTimer(timer, target);
+            return;
+        }
     }
 
     TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
     timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, timer);
+    addTimer(timerTarget, timer, target);
     timer->release();
 }
 
@@ -342,139 +675,228 @@ void Scheduler::unschedule(const std::string &key, void *target)
         return;
     }
 
-    //CCASSERT(target);
-    //CCASSERT(selector);
-
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+    auto iter = _timerTargets.find(target);
+    if (iter == _timerTargets.end())
+    {
+        return;
+    }
 
-    if (element)
+    auto& timers = iter->second.timers;
+    for (size_t i = 0; i < timers.size(); ++i)
     {
-        for (int i = 0; i < element->timers->num; ++i)
-        {
-            TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
+        TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(timers[i]);
 
-            if (timer && key == timer->getKey())
+        if (timer && key == timer->getKey())
+        {
+            dequeueTimer(timer);
+            timers.erase(timers.begin() + i);
+            if (timers.empty())
             {
-                if (timer == element->currentTimer && (! timer->isAborted()))
-                {
-                    timer->retain();
-                    timer->setAborted();
-                }
-
-                ccArrayRemoveObjectAtIndex(element->timers, i, true);
-
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-
-                if (element->timers->num == 0)
-                {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
-                }
-
-                return;
+                _timerTargets.erase(iter);
             }
+            timer->release();
+            return;
         }
     }
 }
 
-void Scheduler::priorityIn(tListEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused)
+TimerHandle Scheduler::addTimerHandle(TimerTargetInline *timer, void *target, bool paused)
 {
-    tListEntry *listElement = new (std::nothrow) tListEntry();
+    // kept by the target without being queued, rearm() queues it
+    TimerTarget& timerTarget = getTimerTarget(target, paused);
+    timer->retain();
+    timerTarget.timers.push_back(timer);
 
-    listElement->callback = callback;
-    listElement->target = target;
-    listElement->priority = priority;
-    listElement->paused = paused;
-    listElement->next = listElement->prev = nullptr;
-    listElement->markedForDeletion = false;
-
-    // empty list ?
-    if (! *list)
+    TimerHandle handle;
+    if (_freeTimerHandles.empty())
     {
-        DL_APPEND(*list, listElement);
+        handle.index = static_cast<unsigned int>(_timerHandles.size());
+        _timerHandles.push_back({ nullptr, nullptr, 1 });
     }
     else
     {
-        bool added = false;
+        handle.index = _freeTimerHandles.back();
+        _freeTimerHandles.pop_back();
+    }
+
+    TimerHandleSlot& slot = _timerHandles[handle.index];
+    timer->retain();
+    slot.timer = timer;
+    slot.target = target;
+    handle.generation = slot.generation;
+    return handle;
+}
 
-        for (tListEntry *element = *list; element; element = element->next)
+const Scheduler::TimerHandleSlot* Scheduler::findTimerHandle(TimerHandle handle) const
+{
+    if (handle.index >= _timerHandles.size())
+    {
+        return nullptr;
+    }
+
+    const TimerHandleSlot& slot = _timerHandles[handle.index];
+    if (slot.timer == nullptr || slot.generation != handle.generation)
+    {
+        return nullptr;
+    }
+    return &slot;
+}
+
+bool Scheduler::rearm(TimerHandle handle, float delay)
+{
+    const TimerHandleSlot *slot = findTimerHandle(handle);
+    if (slot == nullptr || slot->timer->isAborted())
+    {
+        return false;
+    }
+
+    slot->timer->setupTimerWithInterval(0.0f, 0, delay);
+    restartTimer(slot->timer, slot->target);
+    return true;
+}
+
+void Scheduler::disarm(TimerHandle handle)
+{
+    const TimerHandleSlot *slot = findTimerHandle(handle);
+    if (slot == nullptr)
+    {
+        return;
+    }
+
+    Timer *timer = slot->timer;
+    if (timer->_heapIndex >= 0)
+    {
+        removeTimerFromHeap(timer);
+    }
+    // an exhausted timer is neither started nor queued again
+    timer->setupTimerWithInterval(0.0f, 0, 0.0f);
+    timer->_timesExecuted = 1;
+}
+
+bool Scheduler::isArmed(TimerHandle handle) const
+{
+    const TimerHandleSlot *slot = findTimerHandle(handle);
+    return slot && !slot->timer->isAborted() && !slot->timer->isExhausted();
+}
+
+void Scheduler::releaseTimer(TimerHandle handle)
+{
+    if (findTimerHandle(handle) == nullptr)
+    {
+        return;
+    }
+
+    TimerHandleSlot& slot = _timerHandles[handle.index];
+    TimerTargetInline *timer = slot.timer;
+    void *target = slot.target;
+    slot.timer = nullptr;
+    slot.target = nullptr;
+    if (++slot.generation == 0)
+    {
+        slot.generation = 1;
+    }
+    _freeTimerHandles.push_back(handle.index);
+
+    // still kept by its target unless the target was unscheduled
+    auto iter = _timerTargets.find(target);
+    if (!timer->isAborted() && iter != _timerTargets.end())
+    {
+        auto& timers = iter->second.timers;
+        auto timerIter = std::find(timers.begin(), timers.end(), timer);
+        if (timerIter != timers.end())
         {
-            if (priority < element->priority)
+            dequeueTimer(timer);
+            timers.erase(timerIter);
+            if (timers.empty())
             {
-                if (element == *list)
-                {
-                    DL_PREPEND(*list, listElement);
-                }
-                else
-                {
-                    listElement->next = element;
-                    listElement->prev = element->prev;
-
-                    element->prev->next = listElement;
-                    element->prev = listElement;
-                }
-
-                added = true;
-                break;
+                _timerTargets.erase(iter);
             }
+            timer->release();
         }
+    }
+    timer->release();
+}
 
-        // Not added? priority has the higher value. Append it.
-        if (! added)
-        {
-            DL_APPEND(*list, listElement);
-        }
+Scheduler::UpdateEntry* Scheduler::findUpdateEntry(const void *target)
+{
+    auto iter = _updateLocations.find(target);
+    if (iter == _updateLocations.end())
+    {
+        return nullptr;
     }
 
-    // update hash entry for quick access
-    tHashUpdateEntry *hashElement = (tHashUpdateEntry *)calloc(sizeof(*hashElement), 1);
-    hashElement->target = target;
-    hashElement->list = list;
-    hashElement->entry = listElement;
-    memset(&hashElement->hh, 0, sizeof(hashElement->hh));
-    HASH_ADD_PTR(_hashForUpdates, target, hashElement);
+    const UpdateLocation& location = iter->second;
+    return location.pending ? &_pendingUpdates[location.index] : &_updates[location.index];
 }
 
-void Scheduler::appendIn(_listEntry **list, const ccSchedulerFunc& callback, void *target, bool paused)
+void Scheduler::removeUpdateEntry(const void *target)
 {
-    tListEntry *listElement = new (std::nothrow) tListEntry();
+    auto iter = _updateLocations.find(target);
+    if (iter == _updateLocations.end())
+    {
+        return;
+    }
 
-    listElement->callback = callback;
-    listElement->target = target;
-    listElement->paused = paused;
-    listElement->priority = 0;
-    listElement->markedForDeletion = false;
+    const UpdateLocation& location = iter->second;
+    UpdateEntry& entry = location.pending ? _pendingUpdates[location.index] : _updates[location.index];
+    entry.markedForDeletion = true;
+    // a callback may be unscheduling itself, it is destroyed only once the update is over
+    if (!_updateLocked)
+    {
+        entry.callback = nullptr;
+    }
 
-    DL_APPEND(*list, listElement);
+    _updateLocations.erase(iter);
+    ++_updateTombstones;
+}
 
-    // update hash entry for quicker access
-    tHashUpdateEntry *hashElement = (tHashUpdateEntry *)calloc(sizeof(*hashElement), 1);
-    hashElement->target = target;
-    hashElement->list = list;
-    hashElement->entry = listElement;
-    memset(&hashElement->hh, 0, sizeof(hashElement->hh));
-    HASH_ADD_PTR(_hashForUpdates, target, hashElement);
+void Scheduler::flushUpdates()
+{
+    if (_updateTombstones == 0 && _pendingUpdates.empty())
+    {
+        return;
+    }
+
+    auto isRemoved = [](const UpdateEntry& entry) { return entry.markedForDeletion; };
+    auto byPriority = [](const UpdateEntry& a, const UpdateEntry& b) { return a.priority < b.priority; };
+
+    // drop the tombstones, entries before the first one keep their index
+    auto firstRemoved = std::find_if(_updates.begin(), _updates.end(), isRemoved);
+    size_t firstMoved = firstRemoved - _updates.begin();
+    _updates.erase(std::remove_if(firstRemoved, _updates.end(), isRemoved), _updates.end());
+    _pendingUpdates.erase(std::remove_if(_pendingUpdates.begin(), _pendingUpdates.end(), isRemoved), _pendingUpdates.end());
+
+    if (!_pendingUpdates.empty())
+    {
+        // new entries go after the ones of the same priority, in the order they were scheduled
+        std::stable_sort(_pendingUpdates.begin(), _pendingUpdates.end(), byPriority);
+        auto firstAfter = std::upper_bound(_updates.begin(), _updates.end(), _pendingUpdates.front(), byPriority);
+        firstMoved = std::min(firstMoved, static_cast<size_t>(firstAfter - _updates.begin()));
+
+        const size_t middle = _updates.size();
+        _updates.insert(_updates.end(),
+                        std::make_move_iterator(_pendingUpdates.begin()),
+                        std::make_move_iterator(_pendingUpdates.end()));
+        std::inplace_merge(_updates.begin(), _updates.begin() + middle, _updates.end(), byPriority);
+        _pendingUpdates.clear();
+    }
+
+    for (size_t i = firstMoved; i < _updates.size(); ++i)
+    {
+        UpdateLocation& location = _updateLocations[_updates[i].target];
+        location.index = i;
+        location.pending = false;
+    }
+    _updateTombstones = 0;
 }
 
 void Scheduler::schedulePerFrame(const ccSchedulerFunc& callback, void *target, int priority, bool paused)
 {
-    tHashUpdateEntry *hashElement = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, hashElement);
-    if (hashElement)
+    UpdateEntry *entry = findUpdateEntry(target);
+    if (entry)
     {
         // change priority: should unschedule it first
-        if (hashElement->entry->priority != priority)
+        if (entry->priority != priority)
         {
             unscheduleUpdate(target);
         }
@@ -486,21 +908,11 @@ void Scheduler::schedulePerFrame(const ccSchedulerFunc& callback, void *target,
         }
     }
 
-    // most of the updates are going to be 0, that's way there
-    // is an special list for updates with priority 0
-    if (priority == 0)
-    {
-        appendIn(&_updates0List, callback, target, paused);
-    }
-    else if (priority < 0)
-    {
-        priorityIn(&_updatesNegList, callback, target, priority, paused);
-    }
-    else
-    {
-        // priority > 0
-        priorityIn(&_updatesPosList, callback, target, priority, paused);
-    }
+    // merged into the sorted array at the start of the next update
+    UpdateLocation& location = _updateLocations[target];
+    location.index = _pendingUpdates.size();
+    location.pending = true;
+    _pendingUpdates.push_back({ callback, target, priority, paused, false });
 }
 
 bool Scheduler::isScheduled(const std::string& key, const void *target) const
@@ -508,22 +920,15 @@ bool Scheduler::isScheduled(const std::string& key, const void *target) const
     CCASSERT(!key.empty(), "Argument key must not be empty");
     CCASSERT(target, "Argument target must be non-nullptr");
     
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    
-    if (!element)
-    {
-        return false;
-    }
-    
-    if (element->timers == nullptr)
+    auto iter = _timerTargets.find(target);
+    if (iter == _timerTargets.end())
     {
         return false;
     }
     
-    for (int i = 0; i < element->timers->num; ++i)
+    for (auto element : iter->second.timers)
     {
-        TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
+        TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element);
         
         if (timer && !timer->isExhausted() && key == timer->getKey())
         {
@@ -534,29 +939,6 @@ bool Scheduler::isScheduled(const std::string& key, const void *target) const
     return false;
 }
 
-void Scheduler::removeUpdateFromHash(struct _listEntry *entry)
-{
-    tHashUpdateEntry *element = nullptr;
-
-    HASH_FIND_PTR(_hashForUpdates, &entry->target, element);
-    if (element)
-    {
-        // list entry
-        DL_DELETE(*element->list, element->entry);
-        if (!_updateHashLocked)
-            CC_SAFE_DELETE(element->entry);
-        else
-        {
-            element->entry->markedForDeletion = true;
-            _updateDeleteVector.push_back(element->entry);
-        }
-
-        // hash entry
-        HASH_DEL(_hashForUpdates, element);
-        free(element);
-    }
-}
-
 void Scheduler::unscheduleUpdate(void *target)
 {
     if (target == nullptr)
@@ -564,10 +946,14 @@ void Scheduler::unscheduleUpdate(void *target)
         return;
     }
 
-    tHashUpdateEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, element);
-    if (element)
-        this->removeUpdateFromHash(element->entry);
+    removeUpdateEntry(target);
+
+    // don't let tombstones pile up while targets come and go between updates
+    if (!_updateLocked && _updateTombstones > 64
+        && _updateTombstones * 2 > _updates.size() + _pendingUpdates.size())
+    {
+        flushUpdates();
+    }
 }
 
 void Scheduler::unscheduleAll(void)
@@ -578,44 +964,30 @@ void Scheduler::unscheduleAll(void)
 void Scheduler::unscheduleAllWithMinPriority(int minPriority)
 {
     // Custom Selectors
-    tHashTimerEntry *element = nullptr;
-    tHashTimerEntry *nextElement = nullptr;
-    for (element = _hashForTimers; element != nullptr;)
+    while (!_timerTargets.empty())
     {
-        // element may be removed in unscheduleAllSelectorsForTarget
-        nextElement = (tHashTimerEntry *)element->hh.next;
-        unscheduleAllForTarget(element->target);
-
-        element = nextElement;
+        unscheduleAllForTarget(const_cast<void*>(_timerTargets.begin()->first));
     }
 
     // Updates selectors
-    tListEntry *entry, *tmp;
-    if(minPriority < 0)
+    for (auto& entry : _updates)
     {
-        DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
+        if (!entry.markedForDeletion && entry.priority >= minPriority)
         {
-            if(entry->priority >= minPriority)
-            {
-                unscheduleUpdate(entry->target);
-            }
+            removeUpdateEntry(entry.target);
         }
     }
-
-    if(minPriority <= 0)
+    for (auto& entry : _pendingUpdates)
     {
-        DL_FOREACH_SAFE(_updates0List, entry, tmp)
+        if (!entry.markedForDeletion && entry.priority >= minPriority)
         {
-            unscheduleUpdate(entry->target);
+            removeUpdateEntry(entry.target);
         }
     }
 
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
+    if (!_updateLocked)
     {
-        if(entry->priority >= minPriority)
-        {
-            unscheduleUpdate(entry->target);
-        }
+        flushUpdates();
     }
 #if CC_ENABLE_SCRIPT_BINDING
     _scriptHandlerEntries.clear();
@@ -631,26 +1003,19 @@ void Scheduler::unscheduleAllForTarget(void *target)
     }
 
     // Custom Selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-
-    if (element)
+    auto iter = _timerTargets.find(target);
+    if (iter != _timerTargets.end())
     {
-        if (ccArrayContainsObject(element->timers, element->currentTimer)
-            && (! element->currentTimer->isAborted()))
-        {
-            element->currentTimer->retain();
-            element->currentTimer->setAborted();
-        }
-        ccArrayRemoveAllObjects(element->timers);
+        std::vector<Timer*> timers = std::move(iter->second.timers);
+        _timerTargets.erase(iter);
 
-        if (_currentTarget == element)
+        for (auto timer : timers)
         {
-            _currentTargetSalvaged = true;
+            dequeueTimer(timer);
         }
-        else
+        for (auto timer : timers)
         {
-            removeHashElement(element);
+            timer->release();
         }
     }
 
@@ -686,20 +1051,17 @@ void Scheduler::resumeTarget(void *target)
     CCASSERT(target != nullptr, "target can't be nullptr!");
 
     // custom selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    if (element)
+    auto iter = _timerTargets.find(target);
+    if (iter != _timerTargets.end())
     {
-        element->paused = false;
+        resumeTimers(iter->second, target);
     }
 
     // update selector
-    tHashUpdateEntry *elementUpdate = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-    if (elementUpdate)
+    UpdateEntry *entry = findUpdateEntry(target);
+    if (entry)
     {
-        CCASSERT(elementUpdate->entry != nullptr, "elementUpdate's entry can't be nullptr!");
-        elementUpdate->entry->paused = false;
+        entry->paused = false;
     }
 }
 
@@ -708,20 +1070,17 @@ void Scheduler::pauseTarget(void *target)
     CCASSERT(target != nullptr, "target can't be nullptr!");
 
     // custom selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    if (element)
+    auto iter = _timerTargets.find(target);
+    if (iter != _timerTargets.end())
     {
-        element->paused = true;
+        pauseTimers(iter->second);
     }
 
     // update selector
-    tHashUpdateEntry *elementUpdate = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-    if (elementUpdate)
+    UpdateEntry *entry = findUpdateEntry(target);
+    if (entry)
     {
-        CCASSERT(elementUpdate->entry != nullptr, "elementUpdate's entry can't be nullptr!");
-        elementUpdate->entry->paused = true;
+        entry->paused = true;
     }
 }
 
@@ -730,19 +1089,17 @@ bool Scheduler::isTargetPaused(void *target)
     CCASSERT( target != nullptr, "target must be non nil" );
 
     // Custom selectors
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    if( element )
+    auto iter = _timerTargets.find(target);
+    if (iter != _timerTargets.end())
     {
-        return element->paused;
+        return iter->second.paused;
     }
     
     // We should check update selectors if target does not have custom selectors
-    tHashUpdateEntry *elementUpdate = nullptr;
-    HASH_FIND_PTR(_hashForUpdates, &target, elementUpdate);
-    if ( elementUpdate )
+    UpdateEntry *entry = findUpdateEntry(target);
+    if (entry)
     {
-        return elementUpdate->entry->paused;
+        return entry->paused;
     }
     
     return false;  // should never get here
@@ -758,160 +1115,164 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     std::set<void*> idsWithSelectors;
 
     // Custom Selectors
-    for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
-        element = (tHashTimerEntry*)element->hh.next)
+    for (auto& pair : _timerTargets)
     {
-        element->paused = true;
-        idsWithSelectors.insert(element->target);
+        pauseTimers(pair.second);
+        idsWithSelectors.insert(const_cast<void*>(pair.first));
     }
 
     // Updates selectors
-    tListEntry *entry, *tmp;
-    if(minPriority < 0)
+    for (auto& entry : _updates)
     {
-        DL_FOREACH_SAFE( _updatesNegList, entry, tmp ) 
+        if (!entry.markedForDeletion && entry.priority >= minPriority)
         {
-            if(entry->priority >= minPriority)
-            {
-                entry->paused = true;
-                idsWithSelectors.insert(entry->target);
-            }
+            entry.paused = true;
+            idsWithSelectors.insert(entry.target);
         }
     }
-
-    if(minPriority <= 0)
+    for (auto& entry : _pendingUpdates)
     {
-        DL_FOREACH_SAFE( _updates0List, entry, tmp )
+        if (!entry.markedForDeletion && entry.priority >= minPriority)
         {
-            entry->paused = true;
-            idsWithSelectors.insert(entry->target);
+            entry.paused = true;
+            idsWithSelectors.insert(entry.target);
         }
     }
 
-    DL_FOREACH_SAFE( _updatesPosList, entry, tmp ) 
+    return idsWithSelectors;
+}
+
+void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
+{
+    for(const auto &obj : targetsToResume) {
+        this->resumeTarget(obj);
+    }
+}
+
+Scheduler::PerformNode* Scheduler::newPerformNode()
+{
+    unsigned long long head = _performFreeNodes.load(std::memory_order_acquire);
+    while ((head & 0xffffffffULL) != 0)
     {
-        if(entry->priority >= minPriority) 
+        PerformNode *node = &_performPool[(head & 0xffffffffULL) - 1];
+        // The tag changes on every push and pop, so the exchange fails
+        // if the node was taken and given back by others meanwhile.
+        const unsigned long long next = (((head >> 32) + 1) << 32) | node->nextFree.load(std::memory_order_relaxed);
+        if (_performFreeNodes.compare_exchange_weak(head, next, std::memory_order_acquire, std::memory_order_acquire))
         {
-            entry->paused = true;
-            idsWithSelectors.insert(entry->target);
+            return node;
         }
     }
 
-    return idsWithSelectors;
+    // the pool ran out during a burst, this node is deleted once performed
+    PerformNode *node = new PerformNode();
+    node->pooled = false;
+    return node;
 }
 
-void Scheduler::resumeTargets(const std::set<void*>& targetsToResume)
+void Scheduler::recyclePerformNode(PerformNode *node)
 {
-    for(const auto &obj : targetsToResume) {
-        this->resumeTarget(obj);
+    node->function = nullptr;
+    if (!node->pooled)
+    {
+        delete node;
+        return;
     }
+
+    const unsigned long long index = static_cast<unsigned long long>(node - _performPool) + 1;
+    unsigned long long head = _performFreeNodes.load(std::memory_order_relaxed);
+    do
+    {
+        node->nextFree.store(static_cast<unsigned int>(head & 0xffffffffULL), std::memory_order_relaxed);
+    } while (!_performFreeNodes.compare_exchange_weak(head, (((head >> 32) + 1) << 32) | index,
+                                                      std::memory_order_release, std::memory_order_relaxed));
 }
 
 void Scheduler::performFunctionInCocosThread(std::function<void ()> function)
 {
-    std::lock_guard<std::mutex> lock(_performMutex);
-    _functionsToPerform.push_back(std::move(function));
+    PerformNode *node = newPerformNode();
+    node->function = std::move(function);
+    node->sequence = _performSequence.fetch_add(1, std::memory_order_relaxed);
+    node->next.store(nullptr, std::memory_order_relaxed);
+
+    // the consumer stops at a node whose successor is not linked yet, and picks it up next frame
+    PerformNode *prev = _performTail.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
 }
 
 void Scheduler::removeAllFunctionsToBePerformedInCocosThread()
 {
-    std::unique_lock<std::mutex> lock(_performMutex);
-    _functionsToPerform.clear();
+    // dropped by the cocos thread when it reaches them
+    _performDiscardBefore.store(_performSequence.load(std::memory_order_relaxed), std::memory_order_relaxed);
 }
 
-// main loop
-void Scheduler::update(float dt)
+void Scheduler::performFunctions()
 {
-    _updateHashLocked = true;
-
-    if (_timeScale != 1.0f)
+    // Functions queued by the ones run here wait for the next frame, like the ones past the budget.
+    PerformNode *last = _performTail.load(std::memory_order_acquire);
+    if (_performHead == last)
     {
-        dt *= _timeScale;
+        return;
     }
 
-    //
-    // Selector callbacks
-    //
-
-    // Iterate over all the Updates' selectors
-    tListEntry *entry, *tmp;
-
-    // updates with priority < 0
-    DL_FOREACH_SAFE(_updatesNegList, entry, tmp)
+    const auto start = std::chrono::steady_clock::now();
+    PerformNode *next = nullptr;
+    while (_performHead != last && (next = _performHead->next.load(std::memory_order_acquire)) != nullptr)
     {
-        if ((! entry->paused) && (! entry->markedForDeletion))
-        {
-            entry->callback(dt);
-        }
-    }
+        // the node becomes the new head, so its function is moved out before running it
+        std::function<void()> function = std::move(next->function);
+        const bool discarded = next->sequence < _performDiscardBefore.load(std::memory_order_relaxed);
+        recyclePerformNode(_performHead);
+        _performHead = next;
 
-    // updates with priority == 0
-    DL_FOREACH_SAFE(_updates0List, entry, tmp)
-    {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+        if (discarded)
         {
-            entry->callback(dt);
+            continue;
         }
-    }
+        function();
 
-    // updates with priority > 0
-    DL_FOREACH_SAFE(_updatesPosList, entry, tmp)
-    {
-        if ((! entry->paused) && (! entry->markedForDeletion))
+        if (_performBudget > 0.0f
+            && std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() >= _performBudget)
         {
-            entry->callback(dt);
+            break;
         }
     }
+}
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
-    {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
+// main loop
+void Scheduler::update(float dt)
+{
+    // bring in the updates scheduled since the last frame before the array is locked
+    flushUpdates();
 
-        if (! _currentTarget->paused)
-        {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
-            {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                CCASSERT
-                  ( !elt->currentTimer->isAborted(),
-                    "An aborted timer should not be updated" );
-
-                elt->currentTimer->update(dt);
-
-                if (elt->currentTimer->isAborted())
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
-
-                elt->currentTimer = nullptr;
-            }
-        }
+    _updateLocked = true;
 
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
+    if (_timeScale != 1.0f)
+    {
+        dt *= _timeScale;
+    }
+
+    //
+    // Selector callbacks
+    //
 
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
+    // Iterate over all the Updates' selectors, in priority order.
+    // The array doesn't change until the next flush, updates scheduled meanwhile run from the next frame.
+    for (size_t i = 0, count = _updates.size(); i < count; ++i)
+    {
+        UpdateEntry& entry = _updates[i];
+        if ((! entry.paused) && (! entry.markedForDeletion))
         {
-            removeHashElement(_currentTarget);
+            entry.callback(dt);
         }
     }
- 
-    // delete all updates that are removed in update
-    for (auto &e : _updateDeleteVector)
-        delete e;
 
-    _updateDeleteVector.clear();
+    // Fire the custom selectors that are due, then start the ones scheduled during this frame
+    _timerTime += dt;
+    fireDueTimers();
+    startTimers();
 
-    _updateHashLocked = false;
-    _currentTarget = nullptr;
+    _updateLocked = false;
 
 #if CC_ENABLE_SCRIPT_BINDING
     //
@@ -938,66 +1299,31 @@ void Scheduler::update(float dt)
     //
     // Functions allocated from another thread
     //
-
-    // Testing size is faster than locking / unlocking.
-    // And almost never there will be functions scheduled to be called.
-    if( !_functionsToPerform.empty() ) {
-        _performMutex.lock();
-        // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = std::move(_functionsToPerform);
-        _performMutex.unlock();
-        
-        for (const auto &function : temp) {
-            function();
-        }
-    }
+    performFunctions();
 }
 
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, unsigned int repeat, float delay, bool paused)
 {
     CCASSERT(target, "Argument target must be non-nullptr");
     
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
+    TimerTarget& timerTarget = getTimerTarget(target, paused);
     
-    if (! element)
+    for (auto element : timerTarget.timers)
     {
-        element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
-        element->target = target;
-        
-        HASH_ADD_PTR(_hashForTimers, target, element);
+        TimerTargetSelector *timer = dynamic_cast<TimerTargetSelector*>(element);
         
-        // Is this the 1st element ? Then set the pause level to all the selectors of this target
-        element->paused = paused;
-    }
-    else
-    {
-        CCASSERT(element->paused == paused, "element's paused should be paused.");
-    }
-    
-    if (element->timers == nullptr)
-    {
-        element->timers = ccArrayNew(10);
-    }
-    else
-    {
-        for (int i = 0; i < element->timers->num; ++i)
+        if (timer && !timer->isExhausted() && selector == timer->getSelector())
         {
-            TimerTargetSelector *timer = dynamic_cast<TimerTargetSelector*>(element->timers->arr[i]);
-            
-            if (timer && !timer->isExhausted() && selector == timer->getSelector())
-            {
-                CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
-                timer->setupTimerWithInterval(interval, repeat, delay);
-                return;
-            }
+            CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
+            timer->setupTimerWithInterval(interval, repeat, delay);
+            restartTimer(timer, target);
+            return;
         }
-        ccArrayEnsureExtraCapacity(element->timers, 1);
     }
     
     TimerTargetSelector *timer = new (std::nothrow) TimerTargetSelector();
     timer->initWithSelector(this, selector, target, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, timer);
+    addTimer(timerTarget, timer, target);
     timer->release();
 }
 
@@ -1011,22 +1337,15 @@ bool Scheduler::isScheduled(SEL_SCHEDULE selector, const Ref *target) const
     CCASSERT(selector, "Argument selector must be non-nullptr");
     CCASSERT(target, "Argument target must be non-nullptr");
     
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    
-    if (!element)
-    {
-        return false;
-    }
-    
-    if (element->timers == nullptr)
+    auto iter = _timerTargets.find(target);
+    if (iter == _timerTargets.end())
     {
         return false;
     }
 
-    for (int i = 0; i < element->timers->num; ++i)
+    for (auto element : iter->second.timers)
     {
-        TimerTargetSelector *timer = dynamic_cast<TimerTargetSelector*>(element->timers->arr[i]);
+        TimerTargetSelector *timer = dynamic_cast<TimerTargetSelector*>(element);
         
         if (timer && !timer->isExhausted() && selector == timer->getSelector())
         {
@@ -1045,45 +1364,27 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
         return;
     }
     
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    
-    if (element)
+    auto iter = _timerTargets.find(target);
+    if (iter == _timerTargets.end())
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        return;
+    }
+
+    auto& timers = iter->second.timers;
+    for (size_t i = 0; i < timers.size(); ++i)
+    {
+        TimerTargetSelector *timer = dynamic_cast<TimerTargetSelector*>(timers[i]);
+        
+        if (timer && selector == timer->getSelector())
         {
-            TimerTargetSelector *timer = dynamic_cast<TimerTargetSelector*>(element->timers->arr[i]);
-            
-            if (timer && selector == timer->getSelector())
+            dequeueTimer(timer);
+            timers.erase(timers.begin() + i);
+            if (timers.empty())
             {
-                if (timer == element->currentTimer && !timer->isAborted())
-                {
-                    timer->retain();
-                    timer->setAborted();
-                }
-                
-                ccArrayRemoveObjectAtIndex(element->timers, i, true);
-                
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-                
-                if (element->timers->num == 0)
-                {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
-                }
-                
-                return;
+                _timerTargets.erase(iter);
             }
+            timer->release();
+            return;
         }
     }
 }
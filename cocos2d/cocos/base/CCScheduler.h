@@ -29,13 +29,17 @@ THE SOFTWARE.
 #ifndef __CCSCHEDULER_H__
 #define __CCSCHEDULER_H__
 
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <mutex>
+#include <new>
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "base/CCRef.h"
 #include "base/CCVector.h"
-#include "base/uthash.h"
 
 NS_CC_BEGIN
 
@@ -63,6 +67,13 @@ public:
     void update(float dt);
     
 protected:
+    friend class Scheduler;
+
+    // Timers owned by the Scheduler are driven by its clock instead of update().
+    void start(double time);
+    void fire(double time);
+    void shift(double offset);
+
     Scheduler* _scheduler; // weak ref
     float _elapsed;
     bool _runForever;
@@ -72,6 +83,12 @@ protected:
     float _delay;
     float _interval;
     bool _aborted;
+
+    double _nextFireTime;
+    double _lastFireTime;
+    ssize_t _heapIndex; // slot in the scheduler's timer heap, -1 when not queued
+    bool _starting; // waiting to be started at the end of the scheduler's update
+    bool _firing; // taken from the heap by the current update
 };
 
 
@@ -114,6 +131,38 @@ protected:
     std::string _key;
 };
 
+// A one-shot timer made by Scheduler::createTimer(). The callback is stored inline
+// and the timer is kept after firing, so rearming it doesn't allocate.
+class CC_DLL TimerTargetInline : public Timer
+{
+public:
+    TimerTargetInline();
+    virtual ~TimerTargetInline();
+
+    template <class T>
+    void initWithCallback(Scheduler* scheduler, const T& callback)
+    {
+        static_assert(sizeof(T) <= sizeof(_storage), "The callback is too big to be stored inline, use Scheduler::schedule() instead.");
+        static_assert(alignof(T) <= alignof(std::max_align_t), "The callback is over-aligned.");
+
+        _scheduler = scheduler;
+        new (_storage) T(callback);
+        _invoke = [](void* storage, float dt) { (*static_cast<T*>(storage))(dt); };
+        _destroy = [](void* storage) { static_cast<T*>(storage)->~T(); };
+        // disarmed until the first rearm
+        setupTimerWithInterval(0.0f, 0, 0.0f);
+        _timesExecuted = 1;
+    }
+
+    virtual void trigger(float dt) override;
+    virtual void cancel() override;
+
+protected:
+    alignas(std::max_align_t) unsigned char _storage[4 * sizeof(void*)];
+    void (*_invoke)(void* storage, float dt);
+    void (*_destroy)(void* storage);
+};
+
 #if CC_ENABLE_SCRIPT_BINDING
 
 class CC_DLL TimerScriptHandler : public Timer
@@ -140,14 +189,19 @@ private:
  * @{
  */
 
-struct _listEntry;
-struct _hashSelectorEntry;
-struct _hashUpdateEntry;
-
 #if CC_ENABLE_SCRIPT_BINDING
 class SchedulerScriptHandlerEntry;
 #endif
 
+/** @brief Identifies a timer made by Scheduler::createTimer().
+ A default constructed handle refers to no timer.
+ */
+struct TimerHandle
+{
+    unsigned int index = 0;
+    unsigned int generation = 0;
+};
+
 /** @brief Scheduler is responsible for triggering the scheduled callbacks.
 You should not use system timer for your game logic. Instead, use this class.
 
@@ -284,6 +338,44 @@ public:
         }, target, priority, paused);
     }
 
+    /** Creates a one-shot timer for a target that is re-armed through its handle.
+     Unlike scheduleOnce() the timer is allocated once: the callback is stored inline, and rearm()
+     doesn't allocate, copy a std::function or look up a key. Meant for cooldowns and other
+     timers that restart many times.
+     The timer is disarmed until rearm() is called. It follows the pause state of the target,
+     stops working when all the target's selectors are unscheduled, and has to be released
+     with releaseTimer().
+     @param target The target of the timer.
+     @param callback A callable taking the elapsed delay, up to four pointers in size.
+     @param paused Whether or not the target is paused.
+     @return The handle of the timer.
+     */
+    template <class T>
+    TimerHandle createTimer(void *target, const T& callback, bool paused)
+    {
+        CCASSERT(target, "Argument target must be non-nullptr");
+
+        TimerTargetInline *timer = new (std::nothrow) TimerTargetInline();
+        timer->initWithCallback(this, callback);
+        TimerHandle handle = addTimerHandle(timer, target, paused);
+        timer->release();
+        return handle;
+    }
+
+    /** Arms the timer to fire once after `delay` seconds, replacing any pending fire.
+     @return False if the handle is stale or its target was unscheduled.
+     */
+    bool rearm(TimerHandle handle, float delay);
+
+    /** Cancels the pending fire of the timer, if any. */
+    void disarm(TimerHandle handle);
+
+    /** Returns whether the timer is waiting to fire. */
+    bool isArmed(TimerHandle handle) const;
+
+    /** Unschedules the timer and frees its handle. */
+    void releaseTimer(TimerHandle handle);
+
 #if CC_ENABLE_SCRIPT_BINDING
     // Schedule for script bindings.
     /** The scheduled script callback will be called every 'interval' seconds.
@@ -422,7 +514,7 @@ public:
     void resumeTargets(const std::set<void*>& targetsToResume);
 
     /** Calls a function on the cocos2d thread. Useful when you need to call a cocos2d function from another thread.
-     This function is thread safe.
+     This function is thread safe and lock-free. Functions run in the order they were queued, from the next update.
      @param function The function to be run in cocos2d thread.
      @since v3.0
      @js NA
@@ -437,6 +529,14 @@ public:
      * @js NA
      */
     void removeAllFunctionsToBePerformedInCocosThread();
+
+    /** Limits the time update() spends each frame on the functions queued with performFunctionInCocosThread().
+     The functions left over run in the next frames, in order. At least one function runs every frame.
+     @param budget The budget in seconds, 0 for no limit. Default is 0.
+     */
+    void setPerformFunctionBudget(float budget) { _performBudget = budget; }
+    /** Gets the time budget of the functions queued with performFunctionInCocosThread(), in seconds. */
+    float getPerformFunctionBudget() const { return _performBudget; }
     
     /////////////////////////////////////
     
@@ -507,40 +607,122 @@ protected:
      */
     void schedulePerFrame(const ccSchedulerFunc& callback, void *target, int priority, bool paused);
     
-    void removeHashElement(struct _hashSelectorEntry *element);
-    void removeUpdateFromHash(struct _listEntry *entry);
-
     // update specific
 
-    void priorityIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused);
-    void appendIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, bool paused);
+    // An update callback. Entries are kept sorted by priority in one array; unscheduled ones stay
+    // in place as tombstones until the array is compacted at the start of the next update.
+    struct UpdateEntry
+    {
+        ccSchedulerFunc callback;
+        void *target;
+        int priority;
+        bool paused;
+        bool markedForDeletion;
+    };
+
+    struct UpdateLocation
+    {
+        size_t index;
+        bool pending; // index is in _pendingUpdates rather than in _updates
+    };
+
+    UpdateEntry* findUpdateEntry(const void *target);
+    void removeUpdateEntry(const void *target);
+    void flushUpdates();
+
+    // timer specific
+
+    // The timers of one target in scheduling order, each holding a reference.
+    struct TimerTarget
+    {
+        std::vector<Timer*> timers;
+        double pausedTime;
+        bool paused;
+    };
+
+    // A queued timer. The heap is ordered by fire time, then by queue order.
+    struct TimerSlot
+    {
+        double fireTime;
+        unsigned long long order;
+        Timer *timer;
+        void *target;
+
+        bool operator<(const TimerSlot& other) const
+        {
+            return fireTime < other.fireTime || (fireTime == other.fireTime && order < other.order);
+        }
+    };
+
+    TimerTarget& getTimerTarget(void *target, bool paused);
+    void addTimer(TimerTarget& timerTarget, Timer *timer, void *target);
+    void restartTimer(Timer *timer, void *target);
+    void dequeueTimer(Timer *timer);
+    void pauseTimers(TimerTarget& timerTarget);
+    void resumeTimers(TimerTarget& timerTarget, void *target);
+    void pushTimer(Timer *timer, void *target);
+    void removeTimerFromHeap(Timer *timer);
+    void siftTimerUp(size_t index);
+    void siftTimerDown(size_t index);
+    void fireDueTimers();
+    void startTimers();
+
+    // Slots of the timers made by createTimer(), reused with a new generation once released.
+    struct TimerHandleSlot
+    {
+        TimerTargetInline *timer;
+        void *target;
+        unsigned int generation;
+    };
+
+    TimerHandle addTimerHandle(TimerTargetInline *timer, void *target, bool paused);
+    const TimerHandleSlot* findTimerHandle(TimerHandle handle) const;
+
+    // perform function specific
+
+    // A node of the queue of functions to perform, defined in the .cpp file.
+    struct PerformNode;
 
+    PerformNode* newPerformNode();
+    void recyclePerformNode(PerformNode *node);
+    void performFunctions();
 
     float _timeScale;
 
     //
     // "updates with priority" stuff
     //
-    struct _listEntry *_updatesNegList;        // list of priority < 0
-    struct _listEntry *_updates0List;            // list priority == 0
-    struct _listEntry *_updatesPosList;        // list priority > 0
-    struct _hashUpdateEntry *_hashForUpdates; // hash used to fetch quickly the list entries for pause,delete,etc
-    std::vector<struct _listEntry *> _updateDeleteVector; // the vector holds list entries that needs to be deleted after update
+    std::vector<UpdateEntry> _updates;        // sorted by priority, lower first
+    std::vector<UpdateEntry> _pendingUpdates; // scheduled since the last flush, in scheduling order
+    std::unordered_map<const void*, UpdateLocation> _updateLocations;
+    size_t _updateTombstones;
 
     // Used for "selectors with interval"
-    struct _hashSelectorEntry *_hashForTimers;
-    struct _hashSelectorEntry *_currentTarget;
-    bool _currentTargetSalvaged;
-    // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
-    bool _updateHashLocked;
+    std::unordered_map<const void*, TimerTarget> _timerTargets;
+    std::vector<TimerSlot> _timerHeap;
+    std::vector<TimerSlot> _dueTimers;
+    std::vector<TimerSlot> _startingTimers;
+    double _timerTime; // scaled time accumulated by update(), timers fire against it
+    unsigned long long _timerOrder;
+    std::vector<TimerHandleSlot> _timerHandles;
+    std::vector<unsigned int> _freeTimerHandles;
+
+    // If true unschedule will not remove anything from the update array. Entries will only be marked for deletion.
+    bool _updateLocked;
     
 #if CC_ENABLE_SCRIPT_BINDING
     Vector<SchedulerScriptHandlerEntry*> _scriptHandlerEntries;
 #endif
     
-    // Used for "perform Function"
-    std::vector<std::function<void()>> _functionsToPerform;
-    std::mutex _performMutex;
+    // Used for "perform Function", a multi-producer single-consumer queue. Producers append at the tail,
+    // update() consumes after the head. Nodes come from a fixed pool with a lock-free free list when possible.
+    PerformNode *_performPool;
+    std::atomic<unsigned long long> _performFreeNodes; // (tag << 32) | (pool index + 1), 0 when empty
+    std::atomic<PerformNode*> _performTail;
+    PerformNode *_performHead;
+    std::atomic<unsigned long long> _performSequence;
+    std::atomic<unsigned long long> _performDiscardBefore; // functions queued before it are dropped
+    float _performBudget;
 };
 
 // end of base group
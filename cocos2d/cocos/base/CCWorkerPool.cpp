@@ -0,0 +1,143 @@
+/****************************************************************************
+Copyright (c) 2010      cocos2d-x.org
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCWorkerPool.h"
+#include <algorithm>
+
+NS_CC_BEGIN
+
+WorkerPool* WorkerPool::s_workerPool = nullptr;
+
+WorkerPool* WorkerPool::getInstance()
+{
+    if (s_workerPool == nullptr)
+    {
+        s_workerPool = new (std::nothrow) WorkerPool();
+    }
+    return s_workerPool;
+}
+
+void WorkerPool::destroyInstance()
+{
+    delete s_workerPool;
+    s_workerPool = nullptr;
+}
+
+WorkerPool::WorkerPool()
+: _job(nullptr)
+, _count(0)
+, _chunkSize(1)
+, _nextChunk(0)
+, _generation(0)
+, _activeWorkers(0)
+, _quit(false)
+{
+    // leave one core to the calling thread
+    unsigned int threadCount = std::thread::hardware_concurrency();
+    threadCount = std::min(std::max(threadCount, 2u) - 1, 7u);
+    for (unsigned int i = 0; i < threadCount; ++i)
+    {
+        _threads.emplace_back(&WorkerPool::loop, this);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _condition.notify_all();
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void WorkerPool::parallelFor(int count, int chunkSize, const std::function<void(int, int)>& job)
+{
+    chunkSize = std::max(chunkSize, 1);
+    if (count <= chunkSize || _threads.empty())
+    {
+        if (count > 0)
+        {
+            job(0, count);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(_runMutex);
+    std::unique_lock<std::mutex> lock(_mutex);
+    _job = &job;
+    _count = count;
+    _chunkSize = chunkSize;
+    _nextChunk = 0;
+    ++_generation;
+    lock.unlock();
+    _condition.notify_all();
+
+    runChunks();
+
+    lock.lock();
+    _doneCondition.wait(lock, [this]() { return _activeWorkers == 0; });
+    _job = nullptr;
+}
+
+void WorkerPool::runChunks()
+{
+    const int chunkCount = (_count + _chunkSize - 1) / _chunkSize;
+    for (int i = _nextChunk++; i < chunkCount; i = _nextChunk++)
+    {
+        int begin = i * _chunkSize;
+        (*_job)(begin, std::min(begin + _chunkSize, _count));
+    }
+}
+
+void WorkerPool::loop()
+{
+    unsigned int generation = 0;
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _condition.wait(lock, [&]() { return _quit || (_job != nullptr && _generation != generation); });
+        if (_quit)
+        {
+            break;
+        }
+
+        generation = _generation;
+        ++_activeWorkers;
+        lock.unlock();
+
+        runChunks();
+
+        lock.lock();
+        --_activeWorkers;
+        _doneCondition.notify_all();
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,107 @@
+/****************************************************************************
+Copyright (c) 2013-2016 Chukong Technologies Inc.
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCWORKER_POOL_H_
+#define __CCWORKER_POOL_H_
+
+#include "platform/CCPlatformMacros.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/**
+* @addtogroup base
+* @{
+*/
+NS_CC_BEGIN
+
+/**
+ * @class WorkerPool
+ * @brief Threads that split a loop with the calling thread, for engine work done every frame.
+ *
+ * Unlike AsyncTaskPool, a run blocks until all of its work is done. Runs from several threads
+ * are serialized. A job must not start another run.
+ * @js NA
+ */
+class CC_DLL WorkerPool
+{
+public:
+    /**
+     * Returns the shared instance of the worker pool.
+     */
+    static WorkerPool* getInstance();
+
+    /**
+     * Destroys the worker pool.
+     */
+    static void destroyInstance();
+
+    /**
+     * Get the number of threads taking part in a run, the calling thread included.
+     */
+    int getConcurrency() const { return static_cast<int>(_threads.size()) + 1; }
+
+    /**
+     * Calls job(begin, end) for consecutive ranges of at most chunkSize indices covering [0, count),
+     * from the workers and the calling thread, and returns once every range is done.
+     * Runs on the calling thread only if there is a single range.
+     *
+     * @param count The number of indices.
+     * @param chunkSize The maximum number of indices given to one call of job.
+     * @param job The function to call for each range.
+     */
+    void parallelFor(int count, int chunkSize, const std::function<void(int, int)>& job);
+
+CC_CONSTRUCTOR_ACCESS:
+    WorkerPool();
+    ~WorkerPool();
+
+protected:
+    void runChunks();
+    void loop();
+
+    static WorkerPool* s_workerPool;
+
+    std::vector<std::thread> _threads;
+    std::mutex _runMutex;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::condition_variable _doneCondition;
+    const std::function<void(int, int)>* _job;
+    int _count;
+    int _chunkSize;
+    std::atomic<int> _nextChunk;
+    unsigned int _generation;
+    int _activeWorkers;
+    bool _quit;
+};
+
+NS_CC_END
+// end group
+/// @}
+#endif //__CCWORKER_POOL_H_
@@ -28,6 +28,8 @@
 #define CC_ALLOCATOR_MACROS_H
 /// @cond DO_NOT_SHOW
 
+#include <new>
+
 #include "base/ccConfig.h"
 #include "platform/CCPlatformMacros.h"
 
@@ -88,6 +90,46 @@
             A.deallocate((T*)object, size); \
         }
 
+    #if CC_ENABLE_ALLOCATOR_POOLS
+
+        // @brief helper macros for allocating a Ref subclass from a pool of its own.
+        // CC_DECLARE_ALLOCATOR_POOL goes in the public section of the class, CC_DEFINE_ALLOCATOR_POOL in its .cpp file,
+        // which has to include CCAllocatorStrategyPool.h. Unlike CC_USE_ALLOCATOR_POOL, the new expression constructs
+        // the object and new (std::nothrow) is supported. Subclasses without a pool of their own have another size,
+        // so they are handed to the global allocator.
+        #define CC_DECLARE_ALLOCATOR_POOL(T) \
+            static void* operator new (size_t size); \
+            static void* operator new (size_t size, const std::nothrow_t&) noexcept; \
+            static void operator delete (void* object, size_t size)
+
+        // The pool is never destroyed, objects may be released after static destructors ran.
+        #define CC_DEFINE_ALLOCATOR_POOL(T) \
+            typedef NS_CC_ALLOCATOR::AllocatorStrategyPool<T, NS_CC_ALLOCATOR::RawObjectTraits<T>, NS_CC_ALLOCATOR::locking_semantics> T##AllocatorPool; \
+            static T##AllocatorPool& get##T##AllocatorPool() \
+            { \
+                static T##AllocatorPool* pool = new (NS_CC_ALLOCATOR::ccAllocatorGlobal.allocate(sizeof(T##AllocatorPool))) T##AllocatorPool("cocos2d.x.allocator." #T); \
+                return *pool; \
+            } \
+            void* T::operator new (size_t size) \
+            { \
+                return get##T##AllocatorPool().allocate(size); \
+            } \
+            void* T::operator new (size_t size, const std::nothrow_t&) noexcept \
+            { \
+                return get##T##AllocatorPool().allocate(size); \
+            } \
+            void T::operator delete (void* object, size_t size) \
+            { \
+                get##T##AllocatorPool().deallocate(object, size); \
+            }
+
+    #else
+
+        #define CC_DECLARE_ALLOCATOR_POOL(...)
+        #define CC_DEFINE_ALLOCATOR_POOL(...)
+
+    #endif
+
 #else
 
     // macros for new/delete
@@ -105,6 +147,8 @@
 
     // throw these away if not enabled
     #define CC_USE_ALLOCATOR_POOL(...)
+    #define CC_DECLARE_ALLOCATOR_POOL(...)
+    #define CC_DEFINE_ALLOCATOR_POOL(...)
     #define CC_OVERRIDE_GLOBAL_NEWDELETE_WITH_ALLOCATOR(...)
 
 #endif
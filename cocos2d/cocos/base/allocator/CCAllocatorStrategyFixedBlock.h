@@ -160,9 +160,20 @@ public:
     std::string diagnostics() const
     {
         std::stringstream s;
-        s << AllocatorBase::tag() << " initial:" << _pageSize << " count:" << _allocated << " highest:" << _highestCount << "\n";
+        s << AllocatorBase::tag() << " initial:" << _pageSize << " count:" << _allocated << " highest:" << _highestCount << " capacity:" << capacity() << "\n";
         return s.str();
     }
+    
+    // @brief Returns the number of blocks in the allocated pages, free or not.
+    size_t capacity() const
+    {
+        size_t pages = 0;
+        for (const void* p = _pages; p; p = (const void*)*(const uintptr_t*)p)
+        {
+            ++pages;
+        }
+        return pages * _pageSize;
+    }
     size_t _highestCount;
 #endif
     
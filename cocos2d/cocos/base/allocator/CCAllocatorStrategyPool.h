@@ -82,6 +82,24 @@ public:
     }
 };
 
+/**
+ * ObjectTraits for a pool backing the operator new and delete of type T.
+ *
+ * The new and delete expressions construct and destroy the object, so the pool doesn't.
+ * @see CC_DECLARE_ALLOCATOR_POOL
+ */
+template <typename T, size_t _alignment = AllocatorBase::kDefaultAlignment>
+class RawObjectTraits : public ObjectTraits<T, _alignment>
+{
+public:
+    
+    void construct(T* /*address*/)
+    {}
+    
+    void destroy(T* /*address*/)
+    {}
+};
+
 /**
  * Fixed sized pool allocator strategy for objects of type T.
  *
@@ -160,7 +178,7 @@ public:
     std::string diagnostics() const
     {
         std::stringstream s;
-        s << AllocatorBase::tag() << " initial:" << tParentStrategy::_pageSize << " count:" << tParentStrategy::_allocated << " highest:" << tParentStrategy::_highestCount << "\n";
+        s << AllocatorBase::tag() << " initial:" << tParentStrategy::_pageSize << " count:" << tParentStrategy::_allocated << " highest:" << tParentStrategy::_highestCount << " capacity:" << tParentStrategy::capacity() << "\n";
         return s.str();
     }    
 #endif
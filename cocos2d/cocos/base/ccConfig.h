@@ -376,6 +376,26 @@ THE SOFTWARE.
 # define CC_ENABLE_ALLOCATOR_DIAGNOSTICS CC_ENABLE_ALLOCATOR
 #endif
 
+/** @def CC_ENABLE_ALLOCATOR_POOLS
+ * Turn on allocating the Ref subclasses created most often (Node, Sprite, Label,
+ * PhysicsBody, PhysicsShapeCircle and EventCustom) from a pool per class.
+ * Requires CC_ENABLE_ALLOCATOR. The initial size of a pool is read from the
+ * Configuration value named after its tag, e.g. "cocos2d.x.allocator.Sprite".
+ */
+#ifndef CC_ENABLE_ALLOCATOR_POOLS
+# define CC_ENABLE_ALLOCATOR_POOLS 0
+#endif
+
+/** @def CC_ENABLE_ATOMIC_REF_COUNT
+ * Turn on atomic reference counts for Ref, so worker threads can retain and release
+ * objects shared with the cocos thread. Ref::autorelease() called off the cocos thread
+ * then keeps the object on the calling thread until PoolManager::flushThreadReleases(),
+ * after which the cocos thread releases it at the end of the frame.
+ */
+#ifndef CC_ENABLE_ATOMIC_REF_COUNT
+# define CC_ENABLE_ATOMIC_REF_COUNT 0
+#endif
+
 /** @def CC_ENABLE_ALLOCATOR_GLOBAL_NEW_DELETE
  * Turn on override of global new and delete
  * as specified by CC_ALLOCATOR_GLOBAL_NEW_DELETE below.
@@ -410,6 +430,36 @@ THE SOFTWARE.
 # define CC_ENABLE_PREMULTIPLIED_ALPHA 1
 #endif
 
+/** @def CC_ENABLE_LAZY_GLPROGRAM_LOADING
+ * If enabled, the built-in shaders are registered at startup but only compiled
+ * the first time they are requested through GLProgramCache::getGLProgram().
+ */
+#ifndef CC_ENABLE_LAZY_GLPROGRAM_LOADING
+# define CC_ENABLE_LAZY_GLPROGRAM_LOADING 1
+#endif
+
+/** @def CC_ENABLE_GLPROGRAM_BINARY_CACHE
+ * If enabled, linked built-in programs are stored in the writable path with
+ * glGetProgramBinary() and restored with glProgramBinary() on the next run.
+ * Programs are compiled from source when the driver rejects a cached binary.
+ */
+#ifndef CC_ENABLE_GLPROGRAM_BINARY_CACHE
+# if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_LINUX)
+#  define CC_ENABLE_GLPROGRAM_BINARY_CACHE 1
+# else
+#  define CC_ENABLE_GLPROGRAM_BINARY_CACHE 0
+# endif
+#endif
+
+/** @def CC_PIXEL_READBACK_BUFFER_COUNT
+ * Number of pixel buffer objects used by Renderer::readPixelsAsync(). A read is
+ * mapped two frames after it was issued; when every buffer is in flight the
+ * oldest one is mapped early, which stalls like a synchronous glReadPixels().
+ */
+#ifndef CC_PIXEL_READBACK_BUFFER_COUNT
+# define CC_PIXEL_READBACK_BUFFER_COUNT 3
+#endif
+
 /** @def CC_STRIP_FPS
  * Whether to strip FPS related data and functions, such as cc_fps_images_png
  */
@@ -90,72 +90,66 @@ void onCaptureScreen(const std::function<void(bool, const std::string&)>& afterC
     int width = static_cast<int>(frameSize.width);
     int height = static_cast<int>(frameSize.height);
 
-    bool succeed = false;
-    std::string outputFile = "";
-
-    do
+    std::string outputFile;
+    if (FileUtils::getInstance()->isAbsolutePath(filename))
     {
-        std::shared_ptr<GLubyte> buffer(new GLubyte[width * height * 4], [](GLubyte* p){ CC_SAFE_DELETE_ARRAY(p); });
-        if (!buffer)
-        {
-            break;
-        }
-
-        glPixelStorei(GL_PACK_ALIGNMENT, 1);
-        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffer.get());
+        outputFile = filename;
+    }
+    else
+    {
+        CCASSERT(filename.find('/') == std::string::npos, "The existence of a relative path is not guaranteed!");
+        outputFile = FileUtils::getInstance()->getWritablePath() + filename;
+    }
 
-        std::shared_ptr<GLubyte> flippedBuffer(new GLubyte[width * height * 4], [](GLubyte* p) { CC_SAFE_DELETE_ARRAY(p); });
-        if (!flippedBuffer)
+    // The pixels arrive a frame or two later without stalling the GPU. They are flipped and
+    // saved in AsyncTaskPool::TaskType::TASK_IO thread, and afterCaptured is called in mainThread
+    Director::getInstance()->getRenderer()->readPixelsAsync(0, 0, width, height, [afterCaptured, outputFile](Data& pixels, int w, int h)
+    {
+        if (pixels.isNull())
         {
-            break;
+            CCLOG("Reading the screen pixels failed!");
+            if (afterCaptured)
+            {
+                afterCaptured(false, outputFile);
+            }
+            startedCapture = false;
+            return;
         }
 
-        for (int row = 0; row < height; ++row)
+        auto succeedSaveToFile = std::make_shared<bool>(false);
+        auto buffer = std::make_shared<Data>(std::move(pixels));
+        std::function<void(void*)> mainThread = [afterCaptured, outputFile, succeedSaveToFile](void* /*param*/)
         {
-            memcpy(flippedBuffer.get() + (height - row - 1) * width * 4, buffer.get() + row * width * 4, width * 4);
-        }
+            if (afterCaptured)
+            {
+                afterCaptured(*succeedSaveToFile, outputFile);
+            }
+            startedCapture = false;
+        };
 
-        Image* image = new (std::nothrow) Image;
-        if (image)
+        AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, std::move(mainThread), nullptr, [buffer, w, h, outputFile, succeedSaveToFile]()
         {
-            image->initWithRawData(flippedBuffer.get(), width * height * 4, width, height, 8);
-            if (FileUtils::getInstance()->isAbsolutePath(filename))
+            std::shared_ptr<GLubyte> flippedBuffer(new (std::nothrow) GLubyte[w * h * 4], [](GLubyte* p) { CC_SAFE_DELETE_ARRAY(p); });
+            if (!flippedBuffer)
             {
-                outputFile = filename;
+                return;
             }
-            else
+
+            const GLubyte* rows = buffer->getBytes();
+            for (int row = 0; row < h; ++row)
             {
-                CCASSERT(filename.find('/') == std::string::npos, "The existence of a relative path is not guaranteed!");
-                outputFile = FileUtils::getInstance()->getWritablePath() + filename;
+                memcpy(flippedBuffer.get() + (h - row - 1) * w * 4, rows + row * w * 4, w * 4);
             }
 
-            // Save image in AsyncTaskPool::TaskType::TASK_IO thread, and call afterCaptured in mainThread
-            static bool succeedSaveToFile = false;
-            std::function<void(void*)> mainThread = [afterCaptured, outputFile](void* /*param*/)
-            {
-                if (afterCaptured)
-                {
-                    afterCaptured(succeedSaveToFile, outputFile);
-                }
-                startedCapture = false;
-            };
-
-            AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, std::move(mainThread), nullptr, [image, outputFile]()
+            Image* image = new (std::nothrow) Image;
+            if (image)
             {
-                succeedSaveToFile = image->saveToFile(outputFile);
+                image->initWithRawData(flippedBuffer.get(), w * h * 4, w, h, 8);
+                *succeedSaveToFile = image->saveToFile(outputFile);
                 delete image;
-            });
-        }
-        else
-        {
-            CCLOG("Malloc Image memory failed!");
-            if (afterCaptured)
-            {
-                afterCaptured(succeed, outputFile);
             }
-            startedCapture = false;
-        }
-    } while (0);
+        });
+    });
 }
 
 /*
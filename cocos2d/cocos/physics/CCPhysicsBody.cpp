@@ -36,6 +36,7 @@
 #include "physics/CCPhysicsJoint.h"
 #include "physics/CCPhysicsWorld.h"
 #include "physics/CCPhysicsHelper.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 static void internalBodySetMass(cpBody *body, cpFloat mass)
 {
@@ -69,6 +70,8 @@ static void internalBodyUpdateVelocity(cpBody *body, cpVect gravity, cpFloat dam
 }
 
 NS_CC_BEGIN
+
+CC_DEFINE_ALLOCATOR_POOL(PhysicsBody)
 extern const float PHYSICS_INFINITY;
 
 const std::string PhysicsBody::COMPONENT_NAME = "PhysicsBody";
@@ -104,6 +107,17 @@ PhysicsBody::PhysicsBody()
 , _recordedAngle(0.0)
 , _recordScaleX(1.f)
 , _recordScaleY(1.f)
+, _recordPosX(0.f)
+, _recordPosY(0.f)
+, _recordValid(false)
+, _previousRotation(0.0f)
+, _interpolatedRotation(0.0f)
+, _interpolated(false)
+, _worldIndex(CC_INVALID_INDEX)
+, _delayAdd(false)
+, _delayAddGeneration(0)
+, _delayRemoveWorld(nullptr)
+, _delayRemoveGeneration(0)
 {
     _name = COMPONENT_NAME;
 }
@@ -880,7 +894,7 @@ Vec2 PhysicsBody::local2World(const Vec2& point)
     return PhysicsHelper::cpv2point(cpBodyLocalToWorld(_cpBody, PhysicsHelper::point2cpv(point)));
 }
 
-void PhysicsBody::beforeSimulation(const Mat4& parentToWorldTransform, const Mat4& nodeToWorldTransform, float scaleX, float scaleY, float rotation)
+void PhysicsBody::beforeSimulation(const Mat4& worldToParentTransform, const Mat4& nodeToWorldTransform, float scaleX, float scaleY, float rotation, bool interpolate)
 {
     if (_recordScaleX != scaleX || _recordScaleY != scaleY)
     {
@@ -889,41 +903,92 @@ void PhysicsBody::beforeSimulation(const Mat4& parentToWorldTransform, const Mat
         setScale(scaleX, scaleY);
     }
 
-    // set rotation
-    if (_recordedRotation != rotation)
+    auto worldPosition = _ownerCenterOffset;
+    nodeToWorldTransform.transformVector(worldPosition.x, worldPosition.y, worldPosition.z, 1.f, &worldPosition);
+
+    // Push the owner's transform into the body only when game code has moved the owner
+    // since afterSimulation(). Setting it wakes the body up, so a body set every step
+    // would never fall asleep.
+    static const float SYNC_TOLERANCE = 0.01f;
+    if (interpolate && _interpolated
+        && fabsf(worldPosition.x - _interpolatedPosition.x) <= SYNC_TOLERANCE
+        && fabsf(worldPosition.y - _interpolatedPosition.y) <= SYNC_TOLERANCE
+        && fabsf(rotation - _interpolatedRotation) <= SYNC_TOLERANCE)
     {
-        setRotation(rotation);
+        // the owner shows an interpolated state, afterSimulation() compares against it
+        _recordPosX = _interpolatedPosition.x;
+        _recordPosY = _interpolatedPosition.y;
     }
+    else
+    {
+        const bool rotated = !_recordValid || fabsf(rotation - _recordedRotation) > SYNC_TOLERANCE;
+        const bool moved = !_recordValid
+            || fabsf(worldPosition.x - _recordPosX) > SYNC_TOLERANCE
+            || fabsf(worldPosition.y - _recordPosY) > SYNC_TOLERANCE;
 
-    // set position
-    auto worldPosition = _ownerCenterOffset;
-    nodeToWorldTransform.transformVector(worldPosition.x, worldPosition.y, worldPosition.z, 1.f, &worldPosition);
-    setPosition(worldPosition.x, worldPosition.y);
+        if (rotated)
+        {
+            setRotation(rotation);
+        }
+
+        if (moved)
+        {
+            setPosition(worldPosition.x, worldPosition.y);
+
+            _recordPosX = worldPosition.x;
+            _recordPosY = worldPosition.y;
+        }
 
-    _recordPosX = worldPosition.x;
-    _recordPosY = worldPosition.y;
+        if (rotated || moved)
+        {
+            // teleported, there is nothing to interpolate from
+            _previousPosition = getPosition();
+            _previousRotation = getRotation();
+        }
+        _recordValid = true;
+    }
+    _interpolated = false;
 
     if (_owner->getAnchorPoint() != Vec2::ANCHOR_MIDDLE)
     {
-        parentToWorldTransform.getInversed().transformVector(worldPosition.x, worldPosition.y, worldPosition.z, 1.f, &worldPosition);
+        worldToParentTransform.transformVector(worldPosition.x, worldPosition.y, worldPosition.z, 1.f, &worldPosition);
         _offset.x = worldPosition.x - _owner->getPositionX();
         _offset.y = worldPosition.y - _owner->getPositionY();
     }
 }
 
-void PhysicsBody::afterSimulation(const Mat4& parentToWorldTransform, float parentRotation)
+void PhysicsBody::afterSimulation(const Mat4& worldToParentTransform, float parentRotation, float interpolation)
 {
-    // set Node position   
     auto tmp = getPosition();
+    float rotation = getRotation();
+    if (interpolation < 1.f)
+    {
+        tmp = _previousPosition + (tmp - _previousPosition) * interpolation;
+        rotation = _previousRotation + (rotation - _previousRotation) * interpolation;
+        _interpolatedPosition = tmp;
+        _interpolatedRotation = rotation;
+        _interpolated = true;
+    }
+
+    // set Node position   
     Vec3 positionInParent(tmp.x, tmp.y, 0.f);
     if (_recordPosX != positionInParent.x || _recordPosY != positionInParent.y)
     {
-        parentToWorldTransform.getInversed().transformVector(positionInParent.x, positionInParent.y, positionInParent.z, 1.f, &positionInParent);
+        // beforeSimulation() leaves the body alone while the owner stays where it is put here
+        _recordPosX = positionInParent.x;
+        _recordPosY = positionInParent.y;
+        worldToParentTransform.transformVector(positionInParent.x, positionInParent.y, positionInParent.z, 1.f, &positionInParent);
         _owner->setPosition(positionInParent.x - _offset.x, positionInParent.y - _offset.y);
     }
 
     // set Node rotation
-    _owner->setRotation(getRotation() - parentRotation);
+    _owner->setRotation(rotation - parentRotation);
+}
+
+void PhysicsBody::recordPreviousState()
+{
+    _previousPosition = getPosition();
+    _previousRotation = getRotation();
 }
 
 void PhysicsBody::onEnter()
@@ -961,6 +1026,9 @@ void PhysicsBody::onRemove()
 
 void PhysicsBody::addToPhysicsWorld()
 {
+    // the owner may have been moved while the body was out of the world
+    _recordValid = false;
+
     if (_owner)
     {
         auto scene = _owner->getScene();
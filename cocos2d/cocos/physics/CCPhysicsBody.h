@@ -27,6 +27,7 @@
 #define __CCPHYSICS_BODY_H__
 
 #include "base/ccConfig.h"
+#include "base/allocator/CCAllocatorMacros.h"
 #if CC_USE_PHYSICS
 
 #include "2d/CCComponent.h"
@@ -64,6 +65,8 @@ const PhysicsMaterial PHYSICSBODY_MATERIAL_DEFAULT(0.1f, 0.5f, 0.5f);
 class CC_DLL PhysicsBody : public Component
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(PhysicsBody);
+
     const static std::string COMPONENT_NAME;
 
     /** 
@@ -515,8 +518,9 @@ protected:
     void addToPhysicsWorld();
     void removeFromPhysicsWorld();
 
-    void beforeSimulation(const Mat4& parentToWorldTransform, const Mat4& nodeToWorldTransform, float scaleX, float scaleY, float rotation);
-    void afterSimulation(const Mat4& parentToWorldTransform, float parentRotation);
+    void beforeSimulation(const Mat4& worldToParentTransform, const Mat4& nodeToWorldTransform, float scaleX, float scaleY, float rotation, bool interpolate);
+    void afterSimulation(const Mat4& worldToParentTransform, float parentRotation, float interpolation);
+    void recordPreviousState();
 protected:
     std::vector<PhysicsJoint*> _joints;
     Vector<PhysicsShape*> _shapes;
@@ -557,8 +561,26 @@ protected:
     float _recordScaleX;
     float _recordScaleY;
 
+    // the owner's world position last pushed into or read back from the body
     float _recordPosX;
     float _recordPosY;
+    bool _recordValid;
+
+    // state before the last fixed step, and the state last written to the owner
+    // when the world interpolates between fixed steps
+    Vec2 _previousPosition;
+    float _previousRotation;
+    Vec2 _interpolatedPosition;
+    float _interpolatedRotation;
+    bool _interpolated;
+
+    // slot of the body in its world's body list, and the changes waiting in the delay lists
+    // of the worlds; a delay entry made before the last bump of its generation is stale
+    ssize_t _worldIndex;
+    bool _delayAdd;
+    unsigned int _delayAddGeneration;
+    PhysicsWorld* _delayRemoveWorld;
+    unsigned int _delayRemoveGeneration;
 
     friend class PhysicsWorld;
     friend class PhysicsShape;
@@ -173,6 +173,7 @@ private:
     void* _contactInfo;
     
     friend class EventListenerPhysicsContact;
+    friend class PhysicsWorld;
 };
 
 /**
@@ -196,6 +197,7 @@ private:
     void* _contactInfo;
     
     friend class EventListenerPhysicsContact;
+    friend class PhysicsWorld;
 };
 
 /** Contact listener. It will receive all the contact callbacks. */
@@ -36,8 +36,12 @@
 #include "physics/CCPhysicsBody.h"
 #include "physics/CCPhysicsWorld.h"
 #include "physics/CCPhysicsHelper.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
+
+CC_DEFINE_ALLOCATOR_POOL(PhysicsShapeCircle)
+
 extern const float PHYSICS_INFINITY;
 static cpBody* s_sharedBody = nullptr;
 
@@ -143,8 +147,36 @@ void PhysicsShape::addShape(cpShape* shape)
     if (shape)
     {
         cpShapeSetUserData(shape, this);
-        cpShapeSetFilter(shape, cpShapeFilterNew(_group, CP_ALL_CATEGORIES, CP_ALL_CATEGORIES));
         _cpShapes.push_back(shape);
+        updateFilter();
+    }
+}
+
+void PhysicsShape::updateFilter()
+{
+    // Let the broadphase drop pairs that can neither collide nor need a contact notification,
+    // PhysicsWorld::collisionBeginCallback() still does the exact test. Grouped shapes are left
+    // to the world, except that chipmunk rejects pairs of the same negative group by itself.
+    cpShapeFilter filter = CP_SHAPE_FILTER_ALL;
+    if (_group < 0)
+    {
+        filter.group = _group;
+    }
+    else if (_group == 0)
+    {
+        cpBitmask categories = (cpBitmask)(unsigned int)_categoryBitmask;
+        cpBitmask mask = (cpBitmask)(unsigned int)(_collisionBitmask | _contactTestBitmask);
+        // shapes that interact with nothing stay visible to queries
+        if (categories != 0 && mask != 0)
+        {
+            filter.categories = categories;
+            filter.mask = mask;
+        }
+    }
+
+    for (auto shape : _cpShapes)
+    {
+        cpShapeSetFilter(shape, filter);
     }
 }
 
@@ -955,15 +987,8 @@ void PhysicsShapeEdgeChain::updateScale()
 
 void PhysicsShape::setGroup(int group)
 {
-    if (group < 0)
-    {
-        for (auto shape : _cpShapes)
-        {
-            cpShapeSetFilter(shape, cpShapeFilterNew(group, CP_ALL_CATEGORIES, CP_ALL_CATEGORIES));
-        }
-    }
-    
     _group = group;
+    updateFilter();
 }
 
 bool PhysicsShape::containsPoint(const Vec2& point) const
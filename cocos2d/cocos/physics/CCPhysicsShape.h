@@ -27,6 +27,7 @@
 #define __CCPHYSICS_SHAPE_H__
 
 #include "base/ccConfig.h"
+#include "base/allocator/CCAllocatorMacros.h"
 #if CC_USE_PHYSICS
 
 #include "base/CCRef.h"
@@ -284,7 +285,7 @@ public:
      * Every physics body in a scene can be assigned to up to 32 different categories, each corresponding to a bit in the bit mask. You define the mask values used in your game. In conjunction with the collisionBitMask and contactTestBitMask properties, you define which physics bodies interact with each other and when your game is notified of these interactions.
      * @param bitmask An integer number, the default value is 0xFFFFFFFF (all bits set).
      */
-    void setCategoryBitmask(int bitmask) { _categoryBitmask = bitmask; }
+    void setCategoryBitmask(int bitmask) { _categoryBitmask = bitmask; updateFilter(); }
     
     /**
      * Get a mask that defines which categories this physics body belongs to.
@@ -300,7 +301,7 @@ public:
      * When two bodies share the same space, each body's category mask is tested against the other body's contact mask by performing a logical AND operation. If either comparison results in a non-zero value, an PhysicsContact object is created and passed to the physics world’s delegate. For best performance, only set bits in the contacts mask for interactions you are interested in.
      * @param bitmask An integer number, the default value is 0x00000000 (all bits cleared).
      */
-    void setContactTestBitmask(int bitmask) { _contactTestBitmask = bitmask; }
+    void setContactTestBitmask(int bitmask) { _contactTestBitmask = bitmask; updateFilter(); }
     
     /**
      * Get a mask that defines which categories of bodies cause intersection notifications with this physics body.
@@ -315,7 +316,7 @@ public:
      * When two physics bodies contact each other, a collision may occur. This body's collision mask is compared to the other body's category mask by performing a logical AND operation. If the result is a non-zero value, then this body is affected by the collision. Each body independently chooses whether it wants to be affected by the other body. For example, you might use this to avoid collision calculations that would make negligible changes to a body's velocity.
      * @param bitmask An integer number, the default value is 0xFFFFFFFF (all bits set).
      */
-    void setCollisionBitmask(int bitmask) { _collisionBitmask = bitmask; }
+    void setCollisionBitmask(int bitmask) { _collisionBitmask = bitmask; updateFilter(); }
     
     /**
      * Get a mask that defines which categories of physics bodies can collide with this physics body.
@@ -348,6 +349,7 @@ protected:
     virtual void setScale(float scaleX, float scaleY);
     virtual void updateScale();
     void addShape(cpShape* shape);
+    void updateFilter();
     
 protected:
     PhysicsShape();
@@ -383,6 +385,8 @@ protected:
 class CC_DLL PhysicsShapeCircle : public PhysicsShape
 {
 public:
+    CC_DECLARE_ALLOCATOR_POOL(PhysicsShapeCircle);
+
     /**
      * Creates a PhysicsShapeCircle with specified value.
      *
@@ -26,7 +26,9 @@
 #include "physics/CCPhysicsWorld.h"
 #if CC_USE_PHYSICS
 #include <algorithm>
+#include <chrono>
 #include <climits>
+#include <unordered_map>
 
 #include "chipmunk/chipmunk_private.h"
 #include "physics/CCPhysicsBody.h"
@@ -40,6 +42,7 @@
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventCustom.h"
+#include "base/CCWorkerPool.h"
 
 NS_CC_BEGIN
 const float PHYSICS_INFINITY = FLT_MAX;
@@ -75,6 +78,66 @@ namespace
         PhysicsQueryPointCallbackFunc func;
         void* data;
     }PointQueryCallbackInfo;
+
+    typedef struct RectBatchQueryInfo
+    {
+        cpBB bb;
+        PhysicsShape** shapes;
+        int capacity;
+        int count;
+    }RectBatchQueryInfo;
+
+    cpCollisionID rectBatchQueryFunc(void* /*obj*/, cpShape* shape, cpCollisionID id, RectBatchQueryInfo* info)
+    {
+        if (info->count < info->capacity
+            && cpBBIntersects(info->bb, cpShapeGetBB(shape))
+            && !cpShapeFilterReject(cpShapeGetFilter(shape), CP_SHAPE_FILTER_ALL))
+        {
+            // a PhysicsShape may consist of several chipmunk shapes
+            PhysicsShape* physicsShape = static_cast<PhysicsShape*>(cpShapeGetUserData(shape));
+            if (std::find(info->shapes, info->shapes + info->count, physicsShape) == info->shapes + info->count)
+            {
+                info->shapes[info->count++] = physicsShape;
+            }
+        }
+        return id;
+    }
+
+    // number of queries handled by one job of a parallel batch
+    const int QUERY_BATCH_CHUNK = 32;
+
+    // Spatial index queries don't modify the space, so they can run concurrently
+    // as long as the world isn't stepped at the same time.
+    void runQueryBatch(int count, bool parallel, const std::function<void(int, int)>& query)
+    {
+        if (!parallel)
+        {
+            query(0, count);
+            return;
+        }
+
+        WorkerPool::getInstance()->parallelFor(count, QUERY_BATCH_CHUNK, query);
+    }
+
+    // adds the time until it goes out of scope to a PhysicsWorldStats time, in milliseconds
+    class StatsTimer
+    {
+    public:
+        explicit StatsTimer(float& time)
+        : _time(time)
+        , _start(std::chrono::steady_clock::now())
+        {
+        }
+
+        ~StatsTimer()
+        {
+            _time += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _start).count();
+        }
+
+    private:
+        float& _time;
+        std::chrono::steady_clock::time_point _start;
+    };
 }
 
 class PhysicsWorldCallback
@@ -102,6 +165,20 @@ cpBool PhysicsWorldCallback::collisionBeginCallbackFunc(cpArbiter *arb, struct c
     PhysicsShape *shapeA = static_cast<PhysicsShape*>(cpShapeGetUserData(a));
     PhysicsShape *shapeB = static_cast<PhysicsShape*>(cpShapeGetUserData(b));
     CC_ASSERT(shapeA != nullptr && shapeB != nullptr);
+
+    // Only pairs that need a notification get a PhysicsContact, the others are
+    // decided here and the remaining callbacks skip them.
+    if (world->isCollisionDisabledByJoint(shapeA->getBody(), shapeB->getBody()))
+    {
+        cpArbiterSetUserData(arb, nullptr);
+        return cpFalse;
+    }
+
+    if (!PhysicsWorld::isContactTestEnabled(shapeA, shapeB))
+    {
+        cpArbiterSetUserData(arb, nullptr);
+        return PhysicsWorld::isCollisionEnabled(shapeA, shapeB);
+    }
     
     auto contact = PhysicsContact::construct(shapeA, shapeB);
     cpArbiterSetUserData(arb, contact);
@@ -112,17 +189,40 @@ cpBool PhysicsWorldCallback::collisionBeginCallbackFunc(cpArbiter *arb, struct c
 
 cpBool PhysicsWorldCallback::collisionPreSolveCallbackFunc(cpArbiter *arb, cpSpace* /*space*/, PhysicsWorld *world)
 {
-    return world->collisionPreSolveCallback(*static_cast<PhysicsContact*>(cpArbiterGetUserData(arb)));
+    PhysicsContact* contact = static_cast<PhysicsContact*>(cpArbiterGetUserData(arb));
+    if (contact == nullptr)
+    {
+        return cpTrue;
+    }
+
+    return world->collisionPreSolveCallback(*contact);
 }
 
 void PhysicsWorldCallback::collisionPostSolveCallbackFunc(cpArbiter *arb, cpSpace* /*space*/, PhysicsWorld *world)
 {
-    world->collisionPostSolveCallback(*static_cast<PhysicsContact*>(cpArbiterGetUserData(arb)));
+    PhysicsContact* contact = static_cast<PhysicsContact*>(cpArbiterGetUserData(arb));
+    if (contact == nullptr)
+    {
+        return;
+    }
+
+    world->collisionPostSolveCallback(*contact);
 }
 
 void PhysicsWorldCallback::collisionSeparateCallbackFunc(cpArbiter *arb, cpSpace* /*space*/, PhysicsWorld *world)
 {
     PhysicsContact* contact = static_cast<PhysicsContact*>(cpArbiterGetUserData(arb));
+    if (contact == nullptr)
+    {
+        return;
+    }
+
+    if (world->_asyncStepRunning)
+    {
+        // deleted once the event has been dispatched on the cocos thread
+        world->queueContactEvent(*contact, PhysicsContact::EventCode::SEPARATE);
+        return;
+    }
     
     world->collisionSeparateCallback(*contact);
     
@@ -297,61 +397,180 @@ void PhysicsWorld::debugDraw()
     }
 }
 
-bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
+bool PhysicsWorld::isCollisionDisabledByJoint(PhysicsBody* bodyA, PhysicsBody* bodyB) const
 {
-    bool ret = true;
-    
-    PhysicsShape* shapeA = contact.getShapeA();
-    PhysicsShape* shapeB = contact.getShapeB();
-    PhysicsBody* bodyA = shapeA->getBody();
-    PhysicsBody* bodyB = shapeB->getBody();
-    std::vector<PhysicsJoint*> jointsA = bodyA->getJoints();
-    
-    // check the joint is collision enable or not
-    for (PhysicsJoint* joint : jointsA)
+    if (_jointPairs.empty())
+    {
+        return false;
+    }
+
+    auto iter = _jointPairs.find(std::minmax(bodyA, bodyB));
+    if (iter == _jointPairs.end())
+    {
+        return false;
+    }
+
+    for (auto joint : iter->second)
     {
-        if (std::find(_joints.begin(), _joints.end(), joint) == _joints.end())
-        {
-            continue;
-        }
-        
         if (!joint->isCollisionEnabled())
         {
-            PhysicsBody* body = joint->getBodyA() == bodyA ? joint->getBodyB() : joint->getBodyA();
-            
-            if (body == bodyB)
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PhysicsWorld::isContactTestEnabled(PhysicsShape* shapeA, PhysicsShape* shapeB)
+{
+    return (shapeA->getCategoryBitmask() & shapeB->getContactTestBitmask()) != 0
+        && (shapeA->getContactTestBitmask() & shapeB->getCategoryBitmask()) != 0;
+}
+
+bool PhysicsWorld::isCollisionEnabled(PhysicsShape* shapeA, PhysicsShape* shapeB)
+{
+    if (shapeA->getGroup() != 0 && shapeA->getGroup() == shapeB->getGroup())
+    {
+        return shapeA->getGroup() > 0;
+    }
+
+    return (shapeA->getCategoryBitmask() & shapeB->getCollisionBitmask()) != 0
+        && (shapeB->getCategoryBitmask() & shapeA->getCollisionBitmask()) != 0;
+}
+
+static inline uint64_t contactHandlerKey(int categoryA, int categoryB)
+{
+    return ((uint64_t)(unsigned int)categoryA << 32) | (unsigned int)categoryB;
+}
+
+void PhysicsWorld::setContactHandler(int categoryA, int categoryB, const PhysicsContactHandler& handler)
+{
+    removeContactHandler(categoryA, categoryB);
+    _contactHandlers[contactHandlerKey(categoryA, categoryB)] = std::make_shared<PhysicsContactHandler>(handler);
+}
+
+void PhysicsWorld::removeContactHandler(int categoryA, int categoryB)
+{
+    _contactHandlers.erase(contactHandlerKey(categoryA, categoryB));
+    _contactHandlers.erase(contactHandlerKey(categoryB, categoryA));
+}
+
+void PhysicsWorld::removeAllContactHandlers()
+{
+    _contactHandlers.clear();
+}
+
+const std::shared_ptr<PhysicsContactHandler>* PhysicsWorld::findContactHandler(PhysicsShape* shapeA, PhysicsShape* shapeB, bool* swapped) const
+{
+    if (_contactHandlers.empty())
+    {
+        return nullptr;
+    }
+
+    auto iter = _contactHandlers.find(contactHandlerKey(shapeA->getCategoryBitmask(), shapeB->getCategoryBitmask()));
+    if (iter != _contactHandlers.end())
+    {
+        *swapped = false;
+        return &iter->second;
+    }
+
+    iter = _contactHandlers.find(contactHandlerKey(shapeB->getCategoryBitmask(), shapeA->getCategoryBitmask()));
+    if (iter != _contactHandlers.end())
+    {
+        *swapped = true;
+        return &iter->second;
+    }
+
+    return nullptr;
+}
+
+void PhysicsWorld::dispatchContact(PhysicsContact& contact)
+{
+    StatsTimer timer(_frameStats.dispatchTime);
+
+    bool swapped = false;
+    auto found = findContactHandler(contact.getShapeA(), contact.getShapeB(), &swapped);
+    if (found == nullptr)
+    {
+        _eventDispatcher->dispatchEvent(&contact);
+        return;
+    }
+
+    // keep the handler alive if the callback replaces it
+    std::shared_ptr<PhysicsContactHandler> handler = *found;
+    PhysicsBody* bodyA = contact.getShapeA()->getBody();
+    PhysicsBody* bodyB = contact.getShapeB()->getBody();
+    if (swapped)
+    {
+        std::swap(bodyA, bodyB);
+    }
+
+    switch (contact.getEventCode())
+    {
+        case PhysicsContact::EventCode::BEGIN:
+            if (handler->onContactBegin)
             {
-                contact.setNotificationEnable(false);
-                return false;
+                contact.generateContactData();
+                contact.setResult(handler->onContactBegin(contact, bodyA, bodyB));
             }
-        }
+            break;
+        case PhysicsContact::EventCode::PRESOLVE:
+            if (handler->onContactPreSolve)
+            {
+                PhysicsContactPreSolve solve(contact._contactInfo);
+                contact.generateContactData();
+                contact.setResult(handler->onContactPreSolve(contact, solve, bodyA, bodyB));
+            }
+            break;
+        case PhysicsContact::EventCode::POSTSOLVE:
+            if (handler->onContactPostSolve)
+            {
+                PhysicsContactPostSolve solve(contact._contactInfo);
+                handler->onContactPostSolve(contact, solve, bodyA, bodyB);
+            }
+            break;
+        case PhysicsContact::EventCode::SEPARATE:
+            if (handler->onContactSeparate)
+            {
+                handler->onContactSeparate(contact, bodyA, bodyB);
+            }
+            break;
+        default:
+            break;
     }
-    
-    // bitmask check
-    if ((shapeA->getCategoryBitmask() & shapeB->getContactTestBitmask()) == 0
-        || (shapeA->getContactTestBitmask() & shapeB->getCategoryBitmask()) == 0)
+}
+
+bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
+{
+    PhysicsShape* shapeA = contact.getShapeA();
+    PhysicsShape* shapeB = contact.getShapeB();
+
+    // check the joint is collision enable or not
+    if (isCollisionDisabledByJoint(shapeA->getBody(), shapeB->getBody()))
     {
         contact.setNotificationEnable(false);
+        return false;
     }
     
-    if (shapeA->getGroup() != 0 && shapeA->getGroup() == shapeB->getGroup())
-    {
-        ret = shapeA->getGroup() > 0;
-    }
-    else
+    // bitmask check
+    if (!isContactTestEnabled(shapeA, shapeB))
     {
-        if ((shapeA->getCategoryBitmask() & shapeB->getCollisionBitmask()) == 0
-            || (shapeB->getCategoryBitmask() & shapeA->getCollisionBitmask()) == 0)
-        {
-            ret = false;
-        }
+        contact.setNotificationEnable(false);
     }
     
+    bool ret = isCollisionEnabled(shapeA, shapeB);
+    
     if (contact.isNotificationEnabled())
     {
+        if (_asyncStepRunning)
+        {
+            // dispatched by finishAsyncStep(), the listener's result applies from the next step on
+            queueContactEvent(contact, PhysicsContact::EventCode::BEGIN);
+            return ret;
+        }
+
         contact.setEventCode(PhysicsContact::EventCode::BEGIN);
         contact.setWorld(this);
-        _eventDispatcher->dispatchEvent(&contact);
+        dispatchContact(contact);
     }
     
     return ret ? contact.resetResult() : false;
@@ -363,24 +582,30 @@ bool PhysicsWorld::collisionPreSolveCallback(PhysicsContact& contact)
     {
         return true;
     }
+
+    if (_asyncStepRunning)
+    {
+        // result of the deferred BEGIN event
+        return contact._result;
+    }
     
     contact.setEventCode(PhysicsContact::EventCode::PRESOLVE);
     contact.setWorld(this);
-    _eventDispatcher->dispatchEvent(&contact);
+    dispatchContact(contact);
     
     return contact.resetResult();
 }
 
 void PhysicsWorld::collisionPostSolveCallback(PhysicsContact& contact)
 {
-    if (!contact.isNotificationEnabled())
+    if (!contact.isNotificationEnabled() || _asyncStepRunning)
     {
         return;
     }
     
     contact.setEventCode(PhysicsContact::EventCode::POSTSOLVE);
     contact.setWorld(this);
-    _eventDispatcher->dispatchEvent(&contact);
+    dispatchContact(contact);
 }
 
 void PhysicsWorld::collisionSeparateCallback(PhysicsContact& contact)
@@ -392,7 +617,7 @@ void PhysicsWorld::collisionSeparateCallback(PhysicsContact& contact)
     
     contact.setEventCode(PhysicsContact::EventCode::SEPARATE);
     contact.setWorld(this);
-    _eventDispatcher->dispatchEvent(&contact);
+    dispatchContact(contact);
 }
 
 void PhysicsWorld::rayCast(PhysicsRayCastCallbackFunc func, const Vec2& point1, const Vec2& point2, void* data)
@@ -439,6 +664,74 @@ void PhysicsWorld::queryRect(PhysicsQueryRectCallbackFunc func, const Rect& rect
     }
 }
 
+void PhysicsWorld::rayCastBatch(const Vec2* starts, const Vec2* ends, int count, PhysicsRayCastInfo* results, bool parallel/* = false*/)
+{
+    CCASSERT(count <= 0 || (starts != nullptr && ends != nullptr && results != nullptr), "arrays shouldn't be nullptr");
+
+    if (count <= 0)
+    {
+        return;
+    }
+
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+
+    // queries on a spatial hash write its stamp, see useSpatialHash()
+    runQueryBatch(count, parallel && !_spatialHash, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            cpSegmentQueryInfo hit;
+            auto& result = results[i];
+            result.start = starts[i];
+            result.end = ends[i];
+            result.data = nullptr;
+            if (cpSpaceSegmentQueryFirst(_cpSpace, PhysicsHelper::point2cpv(starts[i]), PhysicsHelper::point2cpv(ends[i]),
+                                         0.0f, CP_SHAPE_FILTER_ALL, &hit))
+            {
+                result.shape = static_cast<PhysicsShape*>(cpShapeGetUserData(hit.shape));
+                result.contact = PhysicsHelper::cpv2point(hit.point);
+                result.normal = PhysicsHelper::cpv2point(hit.normal);
+                result.fraction = static_cast<float>(hit.alpha);
+            }
+            else
+            {
+                result.shape = nullptr;
+                result.contact = ends[i];
+                result.normal = Vec2::ZERO;
+                result.fraction = 1.0f;
+            }
+        }
+    });
+}
+
+void PhysicsWorld::queryRectBatch(const Rect* rects, int count, PhysicsShape** shapes, int maxShapesPerRect, int* shapeCounts, bool parallel/* = false*/)
+{
+    CCASSERT(count <= 0 || (rects != nullptr && shapes != nullptr && shapeCounts != nullptr), "arrays shouldn't be nullptr");
+
+    if (count <= 0)
+    {
+        return;
+    }
+
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+
+    // cpSpaceBBQuery() locks the space, query the spatial indices directly
+    runQueryBatch(count, parallel && !_spatialHash, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            RectBatchQueryInfo info = { PhysicsHelper::rect2cpbb(rects[i]), shapes + i * maxShapesPerRect, maxShapesPerRect, 0 };
+            cpSpatialIndexQuery(_cpSpace->dynamicShapes, &info.bb, info.bb, (cpSpatialIndexQueryFunc)rectBatchQueryFunc, &info);
+            cpSpatialIndexQuery(_cpSpace->staticShapes, &info.bb, info.bb, (cpSpatialIndexQueryFunc)rectBatchQueryFunc, &info);
+            shapeCounts[i] = info.count;
+        }
+    });
+}
+
 void PhysicsWorld::queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& point, void* data)
 {
     CCASSERT(func != nullptr, "func shouldn't be nullptr");
@@ -526,8 +819,10 @@ void PhysicsWorld::addBody(PhysicsBody* body)
     }
     
     addBodyOrDelay(body);
+    body->_worldIndex = _bodies.size();
     _bodies.pushBack(body);
     body->_world = this;
+    _bodySyncListDirty = true;
 }
 
 void PhysicsWorld::doAddBody(PhysicsBody* body)
@@ -550,40 +845,67 @@ void PhysicsWorld::doAddBody(PhysicsBody* body)
 
 void PhysicsWorld::addBodyOrDelay(PhysicsBody* body)
 {
-    auto removeBodyIter = _delayRemoveBodies.find(body);
-    if (removeBodyIter != _delayRemoveBodies.end())
+    if (body->_delayRemoveWorld == this)
     {
-        _delayRemoveBodies.erase(removeBodyIter);
+        // cancel the pending removal, the body is still in the space
+        body->_delayRemoveWorld = nullptr;
+        ++body->_delayRemoveGeneration;
         return;
     }
     
-    if (_delayAddBodies.find(body) == _delayAddBodies.end())
+    if (!body->_delayAdd)
     {
-        _delayAddBodies.pushBack(body);
+        body->_delayAdd = true;
+        body->retain();
+        _delayAddBodies.push_back({ body, body->_delayAddGeneration });
     }
 }
 
-void PhysicsWorld::updateBodies()
+void PhysicsWorld::flushDelayBodies(std::vector<DelayBodyEntry>& entries, bool add)
 {
-    if (cpSpaceIsLocked(_cpSpace))
+    // issue #4944, contact callback will be invoked when add/remove body, entries maybe changed, so we need to take them first.
+    std::vector<DelayBodyEntry> pending;
+    pending.swap(entries);
+    for (auto& entry : pending)
     {
-        return;
+        auto body = entry.body;
+        if (add)
+        {
+            if (body->_delayAdd && body->_delayAddGeneration == entry.generation)
+            {
+                body->_delayAdd = false;
+                ++body->_delayAddGeneration;
+                doAddBody(body);
+            }
+        }
+        else if (body->_delayRemoveGeneration == entry.generation)
+        {
+            if (body->_delayRemoveWorld == this)
+            {
+                body->_delayRemoveWorld = nullptr;
+            }
+            doRemoveBody(body);
+        }
+        body->release();
     }
     
-    // issue #4944, contact callback will be invoked when add/remove body, _delayAddBodies maybe changed, so we need make a copy.
-    auto addCopy = _delayAddBodies;
-    _delayAddBodies.clear();
-    for (auto& body : addCopy)
+    // hand the storage back so it isn't reallocated every frame
+    if (entries.empty())
     {
-        doAddBody(body);
+        pending.clear();
+        entries.swap(pending);
     }
-    
-    auto removeCopy = _delayRemoveBodies;
-    _delayRemoveBodies.clear();
-    for (auto& body : removeCopy)
+}
+
+void PhysicsWorld::updateBodies()
+{
+    if (cpSpaceIsLocked(_cpSpace))
     {
-        doRemoveBody(body);
+        return;
     }
+    
+    flushDelayBodies(_delayAddBodies, true);
+    flushDelayBodies(_delayRemoveBodies, false);
 }
 
 void PhysicsWorld::removeBody(int tag)
@@ -615,23 +937,37 @@ void PhysicsWorld::removeBody(PhysicsBody* body)
     body->_joints.clear();
     
     removeBodyOrDelay(body);
-    _bodies.eraseObject(body);
+    
+    // swap the last body into the slot so the removal doesn't shift the list
+    ssize_t last = _bodies.size() - 1;
+    if (body->_worldIndex != last)
+    {
+        _bodies.swap(body->_worldIndex, last);
+        _bodies.at(body->_worldIndex)->_worldIndex = body->_worldIndex;
+    }
+    body->_worldIndex = CC_INVALID_INDEX;
     body->_world = nullptr;
+    _bodies.popBack();
+    _bodySyncListDirty = true;
 }
 
 void PhysicsWorld::removeBodyOrDelay(PhysicsBody* body)
 {
-    if (_delayAddBodies.getIndex(body) != CC_INVALID_INDEX)
+    if (body->_delayAdd)
     {
-        _delayAddBodies.eraseObject(body);
+        // cancel the pending add, the body never reached the space
+        body->_delayAdd = false;
+        ++body->_delayAddGeneration;
         return;
     }
     
     if (cpSpaceIsLocked(_cpSpace))
     {
-        if (_delayRemoveBodies.getIndex(body) == CC_INVALID_INDEX)
+        if (body->_delayRemoveWorld != this)
         {
-            _delayRemoveBodies.pushBack(body);
+            body->_delayRemoveWorld = this;
+            body->retain();
+            _delayRemoveBodies.push_back({ body, body->_delayRemoveGeneration });
         }
     }else
     {
@@ -688,6 +1024,7 @@ void PhysicsWorld::updateJoints()
         if (joint->initJoint())
         {
             _joints.push_back(joint);
+            _jointPairs[std::minmax(joint->getBodyA(), joint->getBodyB())].push_back(joint);
         }
         else
         {
@@ -788,6 +1125,17 @@ void PhysicsWorld::doRemoveJoint(PhysicsJoint* joint)
     _joints.remove(joint);
     joint->_world = nullptr;
 
+    auto pairIter = _jointPairs.find(std::minmax(joint->getBodyA(), joint->getBodyB()));
+    if (pairIter != _jointPairs.end())
+    {
+        auto& pairJoints = pairIter->second;
+        pairJoints.erase(std::remove(pairJoints.begin(), pairJoints.end(), joint), pairJoints.end());
+        if (pairJoints.empty())
+        {
+            _jointPairs.erase(pairIter);
+        }
+    }
+
     if (joint->getBodyA())
     {
         joint->getBodyA()->removeJoint(joint);
@@ -809,10 +1157,12 @@ void PhysicsWorld::removeAllBodies()
     for (auto& child : _bodies)
     {
         removeBodyOrDelay(child);
+        child->_worldIndex = CC_INVALID_INDEX;
         child->_world = nullptr;
     }
     
     _bodies.clear();
+    _bodySyncListDirty = true;
 }
 
 void PhysicsWorld::setDebugDrawMask(int mask)
@@ -846,6 +1196,7 @@ PhysicsBody* PhysicsWorld::getBody(int tag) const
 
 void PhysicsWorld::setGravity(const Vec2& gravity)
 {
+    finishAsyncStep();
     _gravity = gravity;
     cpSpaceSetGravity(_cpSpace, PhysicsHelper::point2cpv(gravity));
 }
@@ -862,6 +1213,87 @@ void PhysicsWorld::setSubsteps(int steps)
     }
 }
 
+void PhysicsWorld::setThreads(int threads)
+{
+#if CC_TARGET_PLATFORM != CC_PLATFORM_WINRT && CC_TARGET_PLATFORM != CC_PLATFORM_WIN32
+    if (threads >= 0)
+    {
+        finishAsyncStep();
+        cpHastySpaceSetThreads(_cpSpace, threads);
+    }
+#else
+    CC_UNUSED_PARAM(threads);
+#endif
+}
+
+int PhysicsWorld::getThreads() const
+{
+#if CC_TARGET_PLATFORM != CC_PLATFORM_WINRT && CC_TARGET_PLATFORM != CC_PLATFORM_WIN32
+    return static_cast<int>(cpHastySpaceGetThreads(_cpSpace));
+#else
+    return 1;
+#endif
+}
+
+void PhysicsWorld::setIterations(int iterations)
+{
+    if (iterations > 0)
+    {
+        finishAsyncStep();
+        cpSpaceSetIterations(_cpSpace, iterations);
+    }
+}
+
+int PhysicsWorld::getIterations() const
+{
+    return cpSpaceGetIterations(_cpSpace);
+}
+
+void PhysicsWorld::setCollisionSlop(float slop)
+{
+    finishAsyncStep();
+    cpSpaceSetCollisionSlop(_cpSpace, slop);
+}
+
+float PhysicsWorld::getCollisionSlop() const
+{
+    return static_cast<float>(cpSpaceGetCollisionSlop(_cpSpace));
+}
+
+void PhysicsWorld::setSleepTimeThreshold(float threshold)
+{
+    finishAsyncStep();
+    cpSpaceSetSleepTimeThreshold(_cpSpace, threshold);
+}
+
+float PhysicsWorld::getSleepTimeThreshold() const
+{
+    return static_cast<float>(cpSpaceGetSleepTimeThreshold(_cpSpace));
+}
+
+void PhysicsWorld::setIdleSpeedThreshold(float threshold)
+{
+    finishAsyncStep();
+    cpSpaceSetIdleSpeedThreshold(_cpSpace, threshold);
+}
+
+float PhysicsWorld::getIdleSpeedThreshold() const
+{
+    return static_cast<float>(cpSpaceGetIdleSpeedThreshold(_cpSpace));
+}
+
+void PhysicsWorld::useSpatialHash(float cellSize, int cellCount)
+{
+    CCASSERT(cellSize > 0.0f && cellCount > 0, "cell size and count should be positive");
+
+    if (cellSize > 0.0f && cellCount > 0)
+    {
+        finishAsyncStep();
+        cpSpaceUseSpatialHash(_cpSpace, cellSize, cellCount);
+        _spatialHash = true;
+    }
+}
+
 void PhysicsWorld::step(float delta)
 {
     if (_autoStep)
@@ -876,6 +1308,7 @@ void PhysicsWorld::step(float delta)
 
 void PhysicsWorld::update(float delta, bool userCall/* = false*/)
 {
+    finishAsyncStep();
 
     if(_preUpdateCallback) _preUpdateCallback(); //fix #11154
 
@@ -888,8 +1321,7 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
         updateBodies();
     }
 
-    auto sceneToWorldTransform = _scene->getNodeToParentTransform();
-    beforeSimulation(_scene, sceneToWorldTransform, 1.f, 1.f, 0.f);
+    beforeSimulation();
 
     if (!_delayAddJoints.empty() || !_delayRemoveJoints.empty())
     {
@@ -898,16 +1330,37 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
 
     if (delta < FLT_EPSILON)
     {
+        publishStats();
         return;
     }
 
+    if (_asyncStep && !userCall)
+    {
+        startAsyncStep(delta);
+        return;
+    }
+
+    simulate(delta, userCall);
+    
+    if (_debugDrawMask != DEBUGDRAW_NONE)
+    {
+        debugDraw();
+    }
+
+    // Update physics position, parents must be handled before their children.
+    // PhysicsWorld::afterSimulation() depends on the depth order of _bodySyncList.
+    afterSimulation(userCall);
+
+    if(_postUpdateCallback) _postUpdateCallback(); //fix #11154
+
+    publishStats();
+}
+
+void PhysicsWorld::simulate(float delta, bool userCall)
+{
     if (userCall)
     {
-#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
-		cpSpaceStep(_cpSpace, delta);
-#else
-		cpHastySpaceStep(_cpSpace, delta);
-#endif
+        stepSpace(delta);
     }
     else
     {
@@ -919,12 +1372,15 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
             while(_updateTime>step)
             {
                 _updateTime-=step;
-#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
-				cpSpaceStep(_cpSpace, dt);
-#else
-				cpHastySpaceStep(_cpSpace, dt);
-#endif
-			}
+                if (_interpolation)
+                {
+                    for (auto& body : _bodies)
+                    {
+                        body->recordPreviousState();
+                    }
+                }
+                stepSpace(dt);
+            }
         }
         else
         {
@@ -933,12 +1389,8 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
                 const float dt = _updateTime * _speed / _substeps;
                 for (int i = 0; i < _substeps; ++i)
                 {
-#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
-					cpSpaceStep(_cpSpace, dt);
-#else
-					cpHastySpaceStep(_cpSpace, dt);
-#endif 
-					for (auto& body : _bodies)
+                    stepSpace(dt);
+                    for (auto& body : _bodies)
                     {
                         body->update(dt);
                     }
@@ -948,17 +1400,182 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
             }
         }
     }
-    
+}
+
+void PhysicsWorld::stepSpace(float dt)
+{
+    // contact callbacks run inside the step, they are counted as dispatch time only
+    const float dispatchTime = _frameStats.dispatchTime;
+    {
+        StatsTimer timer(_frameStats.stepTime);
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+        cpSpaceStep(_cpSpace, dt);
+#else
+        cpHastySpaceStep(_cpSpace, dt);
+#endif
+    }
+    _frameStats.stepTime -= _frameStats.dispatchTime - dispatchTime;
+    ++_frameStats.steps;
+}
+
+void PhysicsWorld::publishStats()
+{
+    cpArray* arbiters = _cpSpace->arbiters;
+    _frameStats.arbiters = arbiters->num;
+    _frameStats.contacts = 0;
+    for (int i = 0; i < arbiters->num; ++i)
+    {
+        _frameStats.contacts += cpArbiterGetCount(static_cast<cpArbiter*>(arbiters->arr[i]));
+    }
+    _frameStats.broadphasePairs = cpHashSetCount(_cpSpace->cachedArbiters);
+
+    _frameStats.sleepingBodies = 0;
+    cpArray* components = _cpSpace->sleepingComponents;
+    for (int i = 0; i < components->num; ++i)
+    {
+        CP_BODY_FOREACH_COMPONENT(static_cast<cpBody*>(components->arr[i]), body)
+        {
+            ++_frameStats.sleepingBodies;
+        }
+    }
+
+    _stats = _frameStats;
+    _frameStats = PhysicsWorldStats();
+}
+
+void PhysicsWorld::setAsyncStep(bool asyncStep)
+{
+    if (!asyncStep)
+    {
+        finishAsyncStep();
+    }
+    _asyncStep = asyncStep;
+}
+
+void PhysicsWorld::startAsyncStep(float delta)
+{
+    if (!_asyncStepThread.joinable())
+    {
+        _asyncStepThread = std::thread(&PhysicsWorld::asyncStepLoop, this);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_asyncStepMutex);
+        _asyncStepRunning = true;
+        _asyncStepDelta = delta;
+        _asyncStepQueued = true;
+    }
+    _asyncStepCondition.notify_all();
+}
+
+void PhysicsWorld::asyncStepLoop()
+{
+    std::unique_lock<std::mutex> lock(_asyncStepMutex);
+    while (true)
+    {
+        _asyncStepCondition.wait(lock, [this]() { return _asyncStepQueued || _asyncStepQuit; });
+        if (_asyncStepQuit)
+        {
+            break;
+        }
+
+        float delta = _asyncStepDelta;
+        lock.unlock();
+        simulate(delta, false);
+        lock.lock();
+
+        _asyncStepQueued = false;
+        _asyncStepCondition.notify_all();
+    }
+}
+
+void PhysicsWorld::finishAsyncStep()
+{
+    if (!_asyncStepRunning)
+    {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(_asyncStepMutex);
+        _asyncStepCondition.wait(lock, [this]() { return !_asyncStepQueued; });
+    }
+    _asyncStepRunning = false;
+
     if (_debugDrawMask != DEBUGDRAW_NONE)
     {
         debugDraw();
     }
 
-    // Update physics position, should loop as the same sequence as node tree.
-    // PhysicsWorld::afterSimulation() will depend on the sequence.
-    afterSimulation(_scene, sceneToWorldTransform, 0.f);
+    afterSimulation(false);
+    dispatchQueuedContacts();
 
     if(_postUpdateCallback) _postUpdateCallback(); //fix #11154
+
+    publishStats();
+}
+
+void PhysicsWorld::queueContactEvent(PhysicsContact& contact, PhysicsContact::EventCode eventCode)
+{
+    QueuedContactEvent event;
+    event.contact = &contact;
+    event.eventCode = eventCode;
+
+    // the arbiter is only valid during the step, copy what the listeners may read
+    cpArbiter* arb = static_cast<cpArbiter*>(contact._contactInfo);
+    if (arb)
+    {
+        event.contactData.count = cpArbiterGetCount(arb);
+        for (int i = 0; i < event.contactData.count && i < PhysicsContactData::POINT_MAX; ++i)
+        {
+            event.contactData.points[i] = PhysicsHelper::cpv2point(cpArbiterGetPointA(arb, i));
+        }
+        event.contactData.normal = event.contactData.count > 0 ? PhysicsHelper::cpv2point(cpArbiterGetNormal(arb)) : Vec2::ZERO;
+    }
+
+    _queuedContacts.push_back(event);
+}
+
+void PhysicsWorld::dispatchQueuedContacts()
+{
+    if (_queuedContacts.empty())
+    {
+        return;
+    }
+
+    // swap first, so the queue stays usable while the listeners run
+    std::vector<QueuedContactEvent> events;
+    events.swap(_queuedContacts);
+
+    // keep the space locked like during a step, so bodies removed by the listeners are delayed
+    // and no contact is separated (and deleted) while it is still in the queue
+    cpSpaceLock(_cpSpace);
+    for (auto& event : events)
+    {
+        PhysicsContact* contact = event.contact;
+        if (contact->isNotificationEnabled())
+        {
+            if (contact->_contactData == nullptr)
+            {
+                contact->_contactData = new (std::nothrow) PhysicsContactData();
+            }
+            *contact->_contactData = event.contactData;
+
+            // the listener must not read the arbiter, its step is over
+            void* contactInfo = contact->_contactInfo;
+            contact->_contactInfo = nullptr;
+            contact->setEventCode(event.eventCode);
+            contact->setWorld(this);
+            dispatchContact(*contact);
+            contact->_contactInfo = contactInfo;
+        }
+
+        if (event.eventCode == PhysicsContact::EventCode::SEPARATE)
+        {
+            delete contact;
+        }
+    }
+    cpSpaceUnlock(_cpSpace, cpTrue);
 }
 
 PhysicsWorld* PhysicsWorld::construct(Scene* scene)
@@ -983,6 +1600,8 @@ PhysicsWorld::PhysicsWorld()
 , _updateTime(0.0f)
 , _substeps(1)
 , _fixedRate(0)
+, _interpolation(false)
+, _spatialHash(false)
 , _cpSpace(nullptr)
 , _updateBodyTransform(false)
 , _scene(nullptr)
@@ -990,14 +1609,52 @@ PhysicsWorld::PhysicsWorld()
 , _debugDraw(nullptr)
 , _debugDrawMask(DEBUGDRAW_NONE)
 , _eventDispatcher(nullptr)
+, _syncPass(0)
+, _bodySyncListDirty(true)
+, _asyncStep(false)
+, _asyncStepRunning(false)
+, _asyncStepQueued(false)
+, _asyncStepQuit(false)
+, _asyncStepDelta(0.0f)
 {
     
 }
 
 PhysicsWorld::~PhysicsWorld()
 {
+    if (_asyncStepThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(_asyncStepMutex);
+            _asyncStepQuit = true;
+        }
+        _asyncStepCondition.notify_all();
+        _asyncStepThread.join();
+    }
+    _asyncStepRunning = false;
+    for (auto& event : _queuedContacts)
+    {
+        if (event.eventCode == PhysicsContact::EventCode::SEPARATE)
+        {
+            delete event.contact;
+        }
+    }
+    _queuedContacts.clear();
+
     removeAllJoints(true);
     removeAllBodies();
+    for (auto& entry : _delayAddBodies)
+    {
+        entry.body->release();
+    }
+    for (auto& entry : _delayRemoveBodies)
+    {
+        if (entry.body->_delayRemoveWorld == this)
+        {
+            entry.body->_delayRemoveWorld = nullptr;
+        }
+        entry.body->release();
+    }
     if (_cpSpace)
     {
 #if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
@@ -1009,37 +1666,194 @@ PhysicsWorld::~PhysicsWorld()
     CC_SAFE_RELEASE_NULL(_debugDraw);
 }
 
-void PhysicsWorld::beforeSimulation(Node *node, const Mat4& parentToWorldTransform, float nodeParentScaleX, float nodeParentScaleY, float parentRotation)
+void PhysicsWorld::rebuildBodySyncList()
 {
-    auto scaleX = nodeParentScaleX * node->getScaleX();
-    auto scaleY = nodeParentScaleY * node->getScaleY();
-    auto rotation = parentRotation + node->getRotation();
+    _bodySyncList.clear();
+    _parentSyncList.clear();
+    _bodySyncListDirty = false;
 
-    auto nodeToWorldTransform = parentToWorldTransform * node->getNodeToParentTransform();
+    std::unordered_map<Node*, int> parentIndices;
+    for (auto& body : _bodies)
+    {
+        Node* owner = body->getNode();
+        if (owner == nullptr)
+        {
+            continue;
+        }
 
-    auto physicsBody = node->getPhysicsBody();
-    if (physicsBody)
+        int depth = 0;
+        Node* node = owner;
+        while (node != nullptr && node != _scene)
+        {
+            node = node->getParent();
+            ++depth;
+        }
+        if (node == nullptr)
+        {
+            // not in the scene, the tree walk wouldn't have reached it either
+            continue;
+        }
+
+        Node* parent = owner == _scene ? nullptr : owner->getParent();
+        auto iter = parentIndices.find(parent);
+        if (iter == parentIndices.end())
+        {
+            ParentSyncEntry entry;
+            entry.parent = parent;
+            entry.version = 0;
+            entry.pass = 0;
+            entry.attached = true;
+            entry.chainHasBody = false;
+            entry.valid = false;
+            entry.scaleX = entry.scaleY = 1.f;
+            entry.rotation = 0.f;
+            for (node = parent; node != nullptr; node = node == _scene ? nullptr : node->getParent())
+            {
+                auto nodeBody = node->getPhysicsBody();
+                if (nodeBody && nodeBody->getWorld() == this)
+                {
+                    entry.chainHasBody = true;
+                    break;
+                }
+            }
+            iter = parentIndices.emplace(parent, (int)_parentSyncList.size()).first;
+            _parentSyncList.push_back(entry);
+        }
+
+        BodySyncEntry bodyEntry;
+        bodyEntry.body = body;
+        bodyEntry.parentIndex = iter->second;
+        bodyEntry.depth = depth;
+        _bodySyncList.push_back(bodyEntry);
+    }
+
+    std::stable_sort(_bodySyncList.begin(), _bodySyncList.end(), [](const BodySyncEntry& a, const BodySyncEntry& b) {
+        return a.depth < b.depth;
+    });
+}
+
+const PhysicsWorld::ParentSyncEntry& PhysicsWorld::validateParentSyncEntry(int index, bool afterSimulation)
+{
+    auto& entry = _parentSyncList[index];
+
+    // Nothing moves while bodies are pushed into the space, and during afterSimulation() only
+    // chains containing body owners can change, so most entries are checked once per pass.
+    if (entry.pass == _syncPass && !(afterSimulation && entry.chainHasBody))
+    {
+        return entry;
+    }
+    entry.pass = _syncPass;
+
+    _syncChain.clear();
+    unsigned int version = 0;
+    if (entry.parent == nullptr)
+    {
+        _scene->getNodeToParentTransform();
+        version = _scene->getTransformVersion();
+    }
+    else
+    {
+        Node* node = entry.parent;
+        for (; node != nullptr; node = node->getParent())
+        {
+            _syncChain.push_back(node);
+            node->getNodeToParentTransform();
+            version += node->getTransformVersion();
+            if (node == _scene)
+            {
+                break;
+            }
+        }
+        entry.attached = node != nullptr;
+    }
+
+    if (!entry.attached || (entry.valid && entry.version == version))
     {
-        physicsBody->beforeSimulation(parentToWorldTransform, nodeToWorldTransform, scaleX, scaleY, rotation);
+        return entry;
+    }
+
+    // same accumulation as the former recursive walk, which started with the scene's transform
+    // as the parent-to-world transform of the scene itself
+    auto parentToWorldTransform = _scene->getNodeToParentTransform();
+    float scaleX = 1.f;
+    float scaleY = 1.f;
+    float rotation = 0.f;
+    for (auto iter = _syncChain.rbegin(); iter != _syncChain.rend(); ++iter)
+    {
+        Node* node = *iter;
+        parentToWorldTransform *= node->getNodeToParentTransform();
+        scaleX *= node->getScaleX();
+        scaleY *= node->getScaleY();
+        rotation += node->getRotation();
     }
 
-    for (auto child : node->getChildren())
-        beforeSimulation(child, nodeToWorldTransform, scaleX, scaleY, rotation);
+    // Mat4 declares no copy assignment, set() copies in place
+    entry.parentToWorldTransform.set(parentToWorldTransform);
+    entry.worldToParentTransform.set(parentToWorldTransform);
+    entry.worldToParentTransform.inverse();
+    entry.scaleX = scaleX;
+    entry.scaleY = scaleY;
+    entry.rotation = rotation;
+    entry.version = version;
+    entry.valid = true;
+    return entry;
 }
 
-void PhysicsWorld::afterSimulation(Node *node, const Mat4& parentToWorldTransform, float parentRotation)
+void PhysicsWorld::beforeSimulation()
 {
-    auto nodeToWorldTransform = parentToWorldTransform * node->getNodeToParentTransform();
-    auto nodeRotation = parentRotation + node->getRotation();
+    StatsTimer timer(_frameStats.syncTime);
 
-    auto physicsBody = node->getPhysicsBody();
-    if (physicsBody)
+    if (_bodySyncListDirty)
     {
-        physicsBody->afterSimulation(parentToWorldTransform, parentRotation);
+        rebuildBodySyncList();
     }
 
-    for (auto child : node->getChildren())
-        afterSimulation(child, nodeToWorldTransform, nodeRotation);
+    const bool interpolate = _interpolation && _fixedRate > 0;
+    ++_syncPass;
+    for (auto& bodyEntry : _bodySyncList)
+    {
+        auto& parentEntry = validateParentSyncEntry(bodyEntry.parentIndex, false);
+        if (!parentEntry.attached)
+        {
+            continue;
+        }
+
+        Node* owner = bodyEntry.body->getNode();
+        auto nodeToWorldTransform = parentEntry.parentToWorldTransform * owner->getNodeToParentTransform();
+        bodyEntry.body->beforeSimulation(parentEntry.worldToParentTransform, nodeToWorldTransform,
+                                         parentEntry.scaleX * owner->getScaleX(),
+                                         parentEntry.scaleY * owner->getScaleY(),
+                                         parentEntry.rotation + owner->getRotation(),
+                                         interpolate);
+    }
+}
+
+void PhysicsWorld::afterSimulation(bool userCall)
+{
+    StatsTimer timer(_frameStats.syncTime);
+
+    // bodies may have been removed by contact callbacks during the step
+    if (_bodySyncListDirty)
+    {
+        rebuildBodySyncList();
+    }
+
+    // fraction of a fixed step not simulated yet, see setInterpolationEnabled()
+    float interpolation = 1.f;
+    if (_interpolation && _fixedRate > 0 && !userCall)
+    {
+        interpolation = clampf(_updateTime * _fixedRate, 0.f, 1.f);
+    }
+
+    ++_syncPass;
+    for (auto& bodyEntry : _bodySyncList)
+    {
+        auto& parentEntry = validateParentSyncEntry(bodyEntry.parentIndex, true);
+        if (parentEntry.attached)
+        {
+            bodyEntry.body->afterSimulation(parentEntry.worldToParentTransform, parentEntry.rotation, interpolation);
+        }
+    }
 }
 
 void PhysicsWorld::setPostUpdateCallback(const std::function<void()> &callback)
@@ -30,9 +30,15 @@
 #if CC_USE_PHYSICS
 
 #include <list>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "base/CCVector.h"
 #include "math/CCGeometry.h"
 #include "physics/CCPhysicsBody.h"
+#include "physics/CCPhysicsContact.h"
 
 struct cpSpace;
 
@@ -85,6 +91,34 @@ typedef std::function<bool(PhysicsWorld& world, const PhysicsRayCastInfo& info,
 typedef std::function<bool(PhysicsWorld&, PhysicsShape&, void*)> PhysicsQueryRectCallbackFunc;
 typedef PhysicsQueryRectCallbackFunc PhysicsQueryPointCallbackFunc;
 
+/**
+ * @brief Contact callbacks for the shapes of two categories, see PhysicsWorld::setContactHandler().
+ * The bodies are passed in the order of the categories the handler was registered with.
+ */
+struct CC_DLL PhysicsContactHandler
+{
+    std::function<bool(PhysicsContact& contact, PhysicsBody* bodyA, PhysicsBody* bodyB)> onContactBegin;
+    std::function<bool(PhysicsContact& contact, PhysicsContactPreSolve& solve, PhysicsBody* bodyA, PhysicsBody* bodyB)> onContactPreSolve;
+    std::function<void(PhysicsContact& contact, const PhysicsContactPostSolve& solve, PhysicsBody* bodyA, PhysicsBody* bodyB)> onContactPostSolve;
+    std::function<void(PhysicsContact& contact, PhysicsBody* bodyA, PhysicsBody* bodyB)> onContactSeparate;
+};
+
+/**
+ * @brief Counters of the last update of a PhysicsWorld, see PhysicsWorld::getStats().
+ * Times are in milliseconds.
+ */
+struct CC_DLL PhysicsWorldStats
+{
+    int steps = 0;              ///< solver steps taken
+    int broadphasePairs = 0;    ///< shape pairs cached from the broadphase, touching within the collision persistence
+    int arbiters = 0;           ///< shape pairs touching in the last step
+    int contacts = 0;           ///< contact points of those pairs
+    int sleepingBodies = 0;     ///< bodies in sleeping groups
+    float stepTime = 0.0f;      ///< in the solver, without the contact callbacks
+    float syncTime = 0.0f;      ///< syncing bodies and nodes before and after the steps
+    float dispatchTime = 0.0f;  ///< in contact listeners and handlers
+};
+
 /**
  * @addtogroup physics
  * @{
@@ -168,6 +202,18 @@ public:
     * @param   data   User defined data, it is passed to func. 
     */
     void rayCast(PhysicsRayCastCallbackFunc func, const Vec2& start, const Vec2& end, void* data);
+
+    /**
+    * Searches the closest shape hit by each ray of a batch.
+    *
+    * Rays are tested without callbacks, so this is much cheaper than many rayCast() calls.
+    * @param   starts   Start positions of the rays, count elements.
+    * @param   ends   End positions of the rays, count elements.
+    * @param   count   Number of rays.
+    * @param   results   Receives count elements, results[i] is the closest hit of ray i. Its shape is nullptr and its fraction 1 if the ray hits nothing.
+    * @param   parallel   true to spread the rays over worker threads, for large batches.
+    */
+    void rayCastBatch(const Vec2* starts, const Vec2* ends, int count, PhysicsRayCastInfo* results, bool parallel = false);
     
     /**
     * Searches for physics shapes that contains in the rect. 
@@ -178,6 +224,19 @@ public:
     * @param   data   User defined data, it is passed to func. 
     */
     void queryRect(PhysicsQueryRectCallbackFunc func, const Rect& rect, void* data);
+
+    /**
+    * Searches the shapes overlapping each rect of a batch.
+    *
+    * Like queryRect(), a shape is found when its bounding box overlaps the rect. Each shape is reported once per rect.
+    * @param   rects   The rects to query, count elements.
+    * @param   count   Number of rects.
+    * @param   shapes   Receives count * maxShapesPerRect elements, the shapes found for rect i start at shapes[i * maxShapesPerRect].
+    * @param   maxShapesPerRect   Number of shapes stored at most for each rect, further shapes are dropped.
+    * @param   shapeCounts   Receives count elements, the number of shapes stored for each rect.
+    * @param   parallel   true to spread the rects over worker threads, for large batches.
+    */
+    void queryRectBatch(const Rect* rects, int count, PhysicsShape** shapes, int maxShapesPerRect, int* shapeCounts, bool parallel = false);
     
     /**
     * Searches for physics shapes that contains the point. 
@@ -211,6 +270,7 @@ public:
     /**
     * Get all the bodies that in this physics world.
     *
+    * @attention Removing a body moves the last body into its place, so the order isn't the order the bodies were added in.
     * @return A Vector<PhysicsBody*>& object contains all bodies in this physics world. 
     */
     const Vector<PhysicsBody*>& getAllBodies() const;
@@ -302,6 +362,116 @@ public:
     /** get the number of substeps */
     int getFixedUpdateRate() const { return _fixedRate; }
 
+    /**
+     * Set whether node transforms are interpolated between fixed steps.
+     *
+     * With a fixed update rate the bodies keep their previous and current states, and the nodes
+     * are placed between them by the fraction of a step left over in this frame. This keeps
+     * motion smooth when the display rate differs from the physics rate, at the cost of showing
+     * the simulation up to one step late. Has no effect if the fixed update rate is 0.
+     * @param enabled A bool object, default value is false.
+     */
+    void setInterpolationEnabled(bool enabled) { _interpolation = enabled; }
+
+    /**
+     * Get whether node transforms are interpolated between fixed steps.
+     *
+     * @return A bool object.
+     */
+    bool isInterpolationEnabled() const { return _interpolation; }
+
+    /**
+     * Set the number of threads the solver runs on.
+     *
+     * 0 lets chipmunk pick the count on iOS and Mac, and means 1 thread elsewhere.
+     * @attention Ignored on Win32 and WinRT, where the world doesn't use cpHastySpace.
+     * @param threads An integer number, default value is 0.
+     */
+    void setThreads(int threads);
+
+    /**
+     * Get the number of threads the solver runs on.
+     *
+     * @return An integer number, always 1 on Win32 and WinRT.
+     */
+    int getThreads() const;
+
+    /**
+     * Set the number of iterations of the impulse solver.
+     *
+     * Fewer iterations are cheaper, more make stacks and joints stiffer.
+     * @param iterations An integer number, default value is 10.
+     */
+    void setIterations(int iterations);
+
+    /**
+     * Get the number of iterations of the impulse solver.
+     *
+     * @return An integer number.
+     */
+    int getIterations() const;
+
+    /**
+     * Set the amount of overlap allowed between colliding shapes.
+     *
+     * A larger slop keeps contacts from jittering and the collision cache warm.
+     * @param slop A float number, default value is 0.1.
+     */
+    void setCollisionSlop(float slop);
+
+    /**
+     * Get the amount of overlap allowed between colliding shapes.
+     *
+     * @return A float number.
+     */
+    float getCollisionSlop() const;
+
+    /**
+     * Set the time a group of bodies must stay idle before it falls asleep.
+     *
+     * Sleeping bodies are skipped by the solver until something touches them.
+     * @param threshold A float number in seconds, default value is INFINITY which disables sleeping.
+     */
+    void setSleepTimeThreshold(float threshold);
+
+    /**
+     * Get the time a group of bodies must stay idle before it falls asleep.
+     *
+     * @return A float number.
+     */
+    float getSleepTimeThreshold() const;
+
+    /**
+     * Set the speed under which a body is considered idle.
+     *
+     * @param threshold A float number, default value is 0 which guesses a threshold from the gravity.
+     */
+    void setIdleSpeedThreshold(float threshold);
+
+    /**
+     * Get the speed under which a body is considered idle.
+     *
+     * @return A float number.
+     */
+    float getIdleSpeedThreshold() const;
+
+    /**
+     * Switch the broadphase from the default bounding box tree to a spatial hash.
+     *
+     * A spatial hash is faster for many shapes of similar size.
+     * @attention It can't be switched back, and batch queries on a spatial hash always run on the calling thread.
+     * @param cellSize The size of a cell, about the size of an average shape.
+     * @param cellCount The minimum number of cells in the hash, about 10 times the number of shapes.
+     */
+    void useSpatialHash(float cellSize, int cellCount);
+
+    /**
+     * Get whether the broadphase is a spatial hash.
+     *
+     * @return A bool object.
+     */
+    bool isUsingSpatialHash() const { return _spatialHash; }
+
     /**
     * Set the debug draw mask of this physics world.
     * 
@@ -352,6 +522,60 @@ public:
      * @param   delta   A float number.
      */
     void step(float delta);
+
+    /**
+     * Set whether automatic steps run on a worker thread.
+     *
+     * When enabled, the step started by the scene runs while the frame is rendered, and its
+     * results are applied on the cocos thread by finishAsyncStep() at the end of the frame:
+     * node transforms are updated, then the queued contact events are dispatched.
+     * @attention Contact listeners only receive BEGIN and SEPARATE events, after the step. Returning
+     * false from onContactBegin ignores the contact from the next step on. Bodies, shapes and joints
+     * must not be accessed from draw callbacks while a step is running.
+     * @param asyncStep A bool object, default value is false.
+     */
+    void setAsyncStep(bool asyncStep);
+
+    /**
+     * Get whether automatic steps run on a worker thread.
+     *
+     * @return A bool object.
+     */
+    bool isAsyncStep() const { return _asyncStep; }
+
+    /**
+     * Wait for the running asynchronous step, apply its results to the nodes and dispatch
+     * the contact events it produced. Does nothing if no step is running.
+     */
+    void finishAsyncStep();
+
+    /**
+     * Get the counters of the last update.
+     *
+     * With an asynchronous step they describe the step finished by the last finishAsyncStep().
+     * @return A PhysicsWorldStats object.
+     */
+    const PhysicsWorldStats& getStats() const { return _stats; }
+
+    /**
+     * Set the contact callbacks for shapes whose category bitmasks are exactly categoryA and categoryB.
+     *
+     * Contacts matching a handler are passed to it directly, with the bodies ordered as the categories,
+     * and are not dispatched to EventListenerPhysicsContact listeners. Other contacts are dispatched
+     * as events. The contact-test bitmasks still decide whether a pair is reported at all.
+     * @param categoryA The category bitmask of the first body passed to the callbacks.
+     * @param categoryB The category bitmask of the second body passed to the callbacks.
+     * @param handler The callbacks, unset ones are skipped.
+     */
+    void setContactHandler(int categoryA, int categoryB, const PhysicsContactHandler& handler);
+
+    /**
+     * Remove the contact callbacks set for categoryA and categoryB, in either order.
+     */
+    void removeContactHandler(int categoryA, int categoryB);
+
+    /** Remove all contact callbacks set with setContactHandler(). */
+    void removeAllContactHandlers();
     
 protected:
     static PhysicsWorld* construct(Scene* scene);
@@ -362,9 +586,23 @@ protected:
     virtual void addShape(PhysicsShape* shape);
     virtual void removeShape(PhysicsShape* shape);
     virtual void update(float delta, bool userCall = false);
+    void simulate(float delta, bool userCall);
+    void stepSpace(float dt);
+    void publishStats();
+    void startAsyncStep(float delta);
+    void asyncStepLoop();
+    void queueContactEvent(PhysicsContact& contact, PhysicsContact::EventCode eventCode);
+    void dispatchQueuedContacts();
 
     virtual void debugDraw();
     
+    bool isCollisionDisabledByJoint(PhysicsBody* bodyA, PhysicsBody* bodyB) const;
+    static bool isContactTestEnabled(PhysicsShape* shapeA, PhysicsShape* shapeB);
+    static bool isCollisionEnabled(PhysicsShape* shapeA, PhysicsShape* shapeB);
+
+    const std::shared_ptr<PhysicsContactHandler>* findContactHandler(PhysicsShape* shapeA, PhysicsShape* shapeB, bool* swapped) const;
+    void dispatchContact(PhysicsContact& contact);
+
     virtual bool collisionBeginCallback(PhysicsContact& contact);
     virtual bool collisionPreSolveCallback(PhysicsContact& contact);
     virtual void collisionPostSolveCallback(PhysicsContact& contact);
@@ -386,11 +624,26 @@ protected:
     float _updateTime;
     int _substeps;
     int _fixedRate;
+    bool _interpolation;
+    bool _spatialHash;
     cpSpace* _cpSpace;
     
     bool _updateBodyTransform;
     Vector<PhysicsBody*> _bodies;
     std::list<PhysicsJoint*> _joints;
+
+    // joints of _joints indexed by their (ordered) body pair, for the contact filter
+    struct BodyPairHash
+    {
+        size_t operator()(const std::pair<PhysicsBody*, PhysicsBody*>& pair) const
+        {
+            return std::hash<PhysicsBody*>()(pair.first) ^ (std::hash<PhysicsBody*>()(pair.second) * 31);
+        }
+    };
+    std::unordered_map<std::pair<PhysicsBody*, PhysicsBody*>, std::vector<PhysicsJoint*>, BodyPairHash> _jointPairs;
+
+    // keyed by categoryA in the high and categoryB in the low 32 bits
+    std::unordered_map<uint64_t, std::shared_ptr<PhysicsContactHandler>> _contactHandlers;
     Scene* _scene;
     
     bool _autoStep;
@@ -399,20 +652,82 @@ protected:
     
     EventDispatcher* _eventDispatcher;
 
-    Vector<PhysicsBody*> _delayAddBodies;
-    Vector<PhysicsBody*> _delayRemoveBodies;
+    // bodies waiting to be added to or removed from the space, each entry holds a reference;
+    // cancelled entries are left in place and skipped by their generation, see PhysicsBody::_delayAdd
+    struct DelayBodyEntry
+    {
+        PhysicsBody* body;
+        unsigned int generation;
+    };
+    std::vector<DelayBodyEntry> _delayAddBodies;
+    std::vector<DelayBodyEntry> _delayRemoveBodies;
+    void flushDelayBodies(std::vector<DelayBodyEntry>& entries, bool add);
     std::vector<PhysicsJoint*> _delayAddJoints;
     std::vector<PhysicsJoint*> _delayRemoveJoints;
     
     std::function<void()> _preUpdateCallback;
     std::function<void()> _postUpdateCallback;
 
+    // Bodies are synced through a list ordered by the depth of their owners, so parents are
+    // always handled before their children. World transforms of the owners' parents are cached
+    // and revalidated with Node::getTransformVersion() instead of walking the whole scene.
+    struct ParentSyncEntry
+    {
+        Node* parent;               // nullptr when the owner is the scene itself
+        unsigned int version;       // sum of the transform versions from parent up to the scene
+        unsigned int pass;          // last sync pass the entry was validated in
+        bool attached;              // whether parent is still a descendant of the scene
+        bool chainHasBody;          // whether a body owner is among parent's ancestors (inclusive)
+        bool valid;
+        Mat4 parentToWorldTransform;
+        Mat4 worldToParentTransform;
+        float scaleX;
+        float scaleY;
+        float rotation;
+    };
+    struct BodySyncEntry
+    {
+        PhysicsBody* body;
+        int parentIndex;
+        int depth;
+    };
+    std::vector<BodySyncEntry> _bodySyncList;
+    std::vector<ParentSyncEntry> _parentSyncList;
+    std::vector<Node*> _syncChain;
+    unsigned int _syncPass;
+    bool _bodySyncListDirty;
+
+    // Asynchronous stepping. _asyncStepRunning is only written by the cocos thread while the
+    // worker is idle; the worker reads it to queue contact events instead of dispatching them.
+    struct QueuedContactEvent
+    {
+        PhysicsContact* contact;
+        PhysicsContact::EventCode eventCode;
+        PhysicsContactData contactData;
+    };
+    bool _asyncStep;
+    bool _asyncStepRunning;
+    bool _asyncStepQueued;
+    bool _asyncStepQuit;
+    float _asyncStepDelta;
+    std::thread _asyncStepThread;
+    std::mutex _asyncStepMutex;
+    std::condition_variable _asyncStepCondition;
+    std::vector<QueuedContactEvent> _queuedContacts;
+
+    // _frameStats is filled during an update (partly by the worker of an asynchronous step)
+    // and copied to _stats when the update is complete
+    PhysicsWorldStats _stats;
+    PhysicsWorldStats _frameStats;
+
 protected:
     PhysicsWorld();
     virtual ~PhysicsWorld();
     
-    void beforeSimulation(Node *node, const Mat4& parentToWorldTransform, float nodeParentScaleX, float nodeParentScaleY, float parentRotation);
-    void afterSimulation(Node* node, const Mat4& parentToWorldTransform, float parentRotation);
+    void rebuildBodySyncList();
+    const ParentSyncEntry& validateParentSyncEntry(int index, bool afterSimulation);
+    void beforeSimulation();
+    void afterSimulation(bool userCall);
 
     friend class Node;
     friend class Sprite;
@@ -154,12 +154,17 @@ void Physics3DComponent::preSimulate()
 
 void Physics3DComponent::postSimulate()
 {
-    if (((int)_syncFlag & (int)Physics3DComponent::PhysicsSyncFlag::PHYSICS_TO_NODE) && _physics3DObj && _owner)
+    if (needPostSimulate())
     {
         syncPhysicsToNode();
     }
 }
 
+bool Physics3DComponent::needPostSimulate() const
+{
+    return ((int)_syncFlag & (int)Physics3DComponent::PhysicsSyncFlag::PHYSICS_TO_NODE) && _physics3DObj && _owner;
+}
+
 void Physics3DComponent::setTransformInPhysics(const cocos2d::Vec3& translateInPhysics, const cocos2d::Quaternion& rotInPhsyics)
 {
     Mat4::createRotation(rotInPhsyics, &_transformInPhysics);
@@ -184,7 +189,16 @@ void Physics3DComponent::syncPhysicsToNode()
         if (_owner->getParent())
             parentMat = _owner->getParent()->getNodeToWorldTransform();
         
-        auto mat = parentMat.getInversed() * _physics3DObj->getWorldTransform();
+        syncPhysicsToNode(parentMat.getInversed());
+    }
+}
+
+void Physics3DComponent::syncPhysicsToNode(const Mat4& worldToParentTransform)
+{
+    if (_physics3DObj->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY
+     || _physics3DObj->getObjType() == Physics3DObject::PhysicsObjType::COLLIDER)
+    {
+        auto mat = worldToParentTransform * _physics3DObj->getWorldTransform();
         //remove scale, no scale support for physics
         float oneOverLen = 1.f / sqrtf(mat.m[0] * mat.m[0] + mat.m[1] * mat.m[1] + mat.m[2] * mat.m[2]);
         mat.m[0] *= oneOverLen;
@@ -200,8 +214,9 @@ void Physics3DComponent::syncPhysicsToNode()
         mat.m[10] *= oneOverLen;
         
         mat *= _transformInPhysics;
-        static Vec3 scale, translation;
-        static Quaternion quat;
+        // locals, this may run on several worker threads at once
+        Vec3 scale, translation;
+        Quaternion quat;
         mat.decompose(&scale, &quat, &translation);
         _owner->setPosition3D(translation);
         quat.normalize();
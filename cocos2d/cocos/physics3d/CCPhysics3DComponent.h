@@ -127,6 +127,10 @@ protected:
     void preSimulate();
     
     void postSimulate();
+    bool needPostSimulate() const;
+    
+    // syncPhysicsToNode() with the inverse of the parent's node to world transform resolved by the caller
+    void syncPhysicsToNode(const cocos2d::Mat4& worldToParentTransform);
     
     cocos2d::Mat4             _transformInPhysics; //transform in physics space
     cocos2d::Mat4             _invTransformInPhysics;
@@ -25,6 +25,7 @@
 
 #include "physics3d/CCPhysics3D.h"
 #include "renderer/CCRenderer.h"
+#include "base/CCWorkerPool.h"
 
 #if CC_USE_3D_PHYSICS
 
@@ -36,6 +37,7 @@ Physics3DWorld::Physics3DWorld()
 : _needCollisionChecking(false)
 , _collisionCheckingFlag(false)
 , _needGhostPairCallbackChecking(false)
+, _parallelSync(false)
 , _btPhyiscsWorld(nullptr)
 , _collisionConfiguration(nullptr)
 , _dispatcher(nullptr)
@@ -101,6 +103,7 @@ bool Physics3DWorld::init(Physics3DWorldDes* info)
     
     _btPhyiscsWorld = new btDiscreteDynamicsWorld(_dispatcher,_broadphase,_solver,_collisionConfiguration);
     _btPhyiscsWorld->setGravity(convertVec3TobtVector3(info->gravity));
+    _parallelSync = info->isParallelSyncEnabled;
     if (info->isDebugDrawEnabled)
     {
         _debugDrawer = new (std::nothrow) Physics3DDebugDrawer();
@@ -238,15 +241,70 @@ void Physics3DWorld::stepSimulate(float dt)
         }
         _btPhyiscsWorld->stepSimulation(dt, 3);
         //sync dynamic node after simulation
-        for (auto it : _physicsComponents)
+        if (!_parallelSync || !postSimulateParallel())
         {
-            it->postSimulate();
+            for (auto it : _physicsComponents)
+            {
+                it->postSimulate();
+            }
         }
         if (needCollisionChecking())
             collisionChecking();
     }
 }
 
+bool Physics3DWorld::postSimulateParallel()
+{
+    static const int SYNC_CHUNK = 64;
+    
+    _syncComponents.clear();
+    _syncParentTransforms.clear();
+    _syncParents.clear();
+    _syncOwners.clear();
+    
+    for (auto it : _physicsComponents)
+    {
+        if (it->needPostSimulate())
+        {
+            _syncOwners.insert(it->getOwner());
+            _syncComponents.push_back(std::make_pair(it, static_cast<size_t>(0)));
+        }
+    }
+    // components sharing an owner would write its transform from several threads
+    if (_syncOwners.size() != _syncComponents.size() || _syncComponents.size() <= SYNC_CHUNK)
+        return false;
+    
+    // resolve the parents' transforms here, getNodeToWorldTransform() updates cached transforms
+    for (auto& entry : _syncComponents)
+    {
+        Node* parent = entry.first->getOwner()->getParent();
+        auto found = _syncParents.find(parent);
+        if (found == _syncParents.end())
+        {
+            // a synced ancestor would be written concurrently with this read
+            for (Node* node = parent; node; node = node->getParent())
+            {
+                if (_syncOwners.count(node))
+                    return false;
+            }
+            
+            const Mat4 parentMat = parent ? parent->getNodeToWorldTransform() : Mat4::IDENTITY;
+            found = _syncParents.emplace(parent, _syncParentTransforms.size()).first;
+            _syncParentTransforms.emplace_back(parentMat.getInversed());
+        }
+        entry.second = found->second;
+    }
+    
+    WorkerPool::getInstance()->parallelFor(static_cast<int>(_syncComponents.size()), SYNC_CHUNK, [this](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            auto& entry = _syncComponents[i];
+            entry.first->syncPhysicsToNode(_syncParentTransforms[entry.second]);
+        }
+    });
+    return true;
+}
+
 void Physics3DWorld::debugDraw(Renderer* renderer)
 {
     if (_debugDrawer)
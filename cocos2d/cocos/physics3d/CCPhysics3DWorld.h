@@ -29,6 +29,8 @@
 #include "math/CCMath.h"
 #include "base/CCRef.h"
 #include "base/ccConfig.h"
+#include <unordered_map>
+#include <unordered_set>
 
 #if CC_USE_3D_PHYSICS
 
@@ -55,6 +57,7 @@ class Physics3DDebugDrawer;
 class Physics3DComponent;
 class Physics3DShape;
 class Renderer;
+class Node;
 
 /**
  * @brief The description of Physics3DWorld.
@@ -62,10 +65,12 @@ class Renderer;
 struct CC_DLL Physics3DWorldDes
 {
     bool           isDebugDrawEnabled; //using physics debug draw?, false by default
+    bool           isParallelSyncEnabled; //write physics transforms back to the nodes on the worker pool?, false by default
     cocos2d::Vec3  gravity;//gravity, (0, -9.8, 0)
     Physics3DWorldDes()
     {
         isDebugDrawEnabled = false;
+        isParallelSyncEnabled = false;
         gravity = cocos2d::Vec3(0.f, -9.8f, 0.f);
     }
 };
@@ -119,6 +124,16 @@ public:
     /** Simulate one frame. */
     void stepSimulate(float dt);
     
+    /**
+     * Enable or disable writing the physics transforms back to the nodes on the WorkerPool after a step.
+     * The parents' transforms are resolved on the calling thread first. Worlds where a node with
+     * a synced component is a descendant of another such node are always synced serially.
+     */
+    void setParallelSyncEnabled(bool enabled) { _parallelSync = enabled; }
+    
+    /** Check parallel write back is enabled. */
+    bool isParallelSyncEnabled() const { return _parallelSync; }
+    
     /** Enable or disable debug drawing. */
     void setDebugDrawEnable(bool enableDebugDraw);
     
@@ -154,6 +169,7 @@ CC_CONSTRUCTOR_ACCESS:
     void collisionChecking();
     bool needCollisionChecking();
     void setGhostPairCallback();
+    bool postSimulateParallel();
     
 protected:
     std::vector<Physics3DObject*>      _objects;
@@ -161,6 +177,13 @@ protected:
     bool _needCollisionChecking;
     bool _collisionCheckingFlag;
     bool _needGhostPairCallbackChecking;
+    bool _parallelSync;
+    
+    // scratch of postSimulateParallel(), components paired with their entry in _syncParentTransforms
+    std::vector<std::pair<Physics3DComponent*, size_t>> _syncComponents;
+    std::vector<cocos2d::Mat4> _syncParentTransforms;
+    std::unordered_map<Node*, size_t> _syncParents;
+    std::unordered_set<Node*> _syncOwners;
     
 #if (CC_ENABLE_BULLET_INTEGRATION)
     btDynamicsWorld* _btPhyiscsWorld;
@@ -34,6 +34,9 @@ THE SOFTWARE.
 #endif
 
 #include "base/CCDirector.h"
+#include "base/CCConfiguration.h"
+#include "renderer/CCRenderer.h"
+#include "base/CCData.h"
 #include "base/ccUTF8.h"
 #include "renderer/ccGLStateCache.h"
 #include "platform/CCFileUtils.h"
@@ -218,6 +221,7 @@ GLProgram::GLProgram()
 : _program(0)
 , _vertShader(0)
 , _fragShader(0)
+, _builtInMatricesValid(false)
 , _flags()
 {
     _director = Director::getInstance();
@@ -318,6 +322,80 @@ bool GLProgram::initWithFilenames(const std::string& vShaderFilename, const std:
     return initWithByteArrays(vertexSource.c_str(), fragmentSource.c_str(), compileTimeHeaders, compileTimeDefines);
 }
 
+bool GLProgram::initWithProgramBinary(GLenum binaryFormat, const Data& binary)
+{
+#if CC_ENABLE_GLPROGRAM_BINARY_CACHE
+    if (!Configuration::getInstance()->supportsProgramBinary() || binary.isNull())
+    {
+        return false;
+    }
+
+    _program = glCreateProgram();
+    _vertShader = _fragShader = 0;
+
+    glProgramBinary(_program, binaryFormat, binary.getBytes(), (GLsizei)binary.getSize());
+
+    // a rejected binary is reported as a link failure, it is not a GL error
+    GLint status = GL_FALSE;
+    glGetProgramiv(_program, GL_LINK_STATUS, &status);
+    glGetError();
+
+    if (status == GL_FALSE)
+    {
+        GL::deleteProgram(_program);
+        _program = 0;
+        return false;
+    }
+
+    clearHashUniforms();
+    parseVertexAttribs();
+    parseUniforms();
+
+    CHECK_GL_ERROR_DEBUG();
+
+    return true;
+#else
+    CC_UNUSED_PARAM(binaryFormat);
+    CC_UNUSED_PARAM(binary);
+    return false;
+#endif
+}
+
+bool GLProgram::getProgramBinary(GLenum* binaryFormat, Data* binary) const
+{
+#if CC_ENABLE_GLPROGRAM_BINARY_CACHE
+    CCASSERT(binaryFormat && binary, "Invalid output parameters");
+
+    if (!Configuration::getInstance()->supportsProgramBinary() || _program == 0)
+    {
+        return false;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(_program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return false;
+    }
+
+    unsigned char* bytes = (unsigned char*)malloc(length);
+    GLsizei written = 0;
+    glGetProgramBinary(_program, length, &written, binaryFormat, bytes);
+    if (glGetError() != GL_NO_ERROR || written <= 0)
+    {
+        free(bytes);
+        return false;
+    }
+
+    binary->fastSet(bytes, written);
+    return true;
+#else
+    CC_UNUSED_PARAM(binaryFormat);
+    CC_UNUSED_PARAM(binary);
+    return false;
+#endif
+}
+
 void GLProgram::bindPredefinedVertexAttribs()
 {
     static const struct {
@@ -393,6 +471,7 @@ void GLProgram::parseUniforms()
         if(length > 0)
         {
             Uniform uniform;
+            uniform.uploadedVersion = 0;
 
             GLchar* uniformName = (GLchar*)alloca(length + 1);
 
@@ -437,6 +516,11 @@ void GLProgram::parseUniforms()
 
     }
 
+    _userUniformsByLocation.clear();
+    for (auto& uniform : _userUniforms)
+    {
+        _userUniformsByLocation[uniform.second.location] = &uniform.second;
+    }
 }
 
 Uniform* GLProgram::getUniform(const std::string &name)
@@ -607,6 +691,13 @@ bool GLProgram::link()
 
     bindPredefinedVertexAttribs();
 
+#if CC_ENABLE_GLPROGRAM_BINARY_CACHE && defined(GL_PROGRAM_BINARY_RETRIEVABLE_HINT)
+    if (Configuration::getInstance()->supportsProgramBinary())
+    {
+        glProgramParameteri(_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+#endif
+
     glLinkProgram(_program);
 
     // Calling glGetProgramiv(...GL_LINK_STATUS...) will force linking of the program at this moment.
@@ -722,9 +813,35 @@ bool GLProgram::updateUniformLocation(GLint location, const GLvoid* data, unsign
         }
     }
 
+    if (updated)
+    {
+        invalidateUniformVersion(location);
+        _director->getRenderer()->addUploadedUniforms(1);
+    }
+    else
+    {
+        _director->getRenderer()->addSkippedUniformUploads(1);
+    }
+
     return updated;
 }
 
+void GLProgram::invalidateUniformVersion(GLint location)
+{
+    auto it = _userUniformsByLocation.find(location);
+    if (it != _userUniformsByLocation.end())
+    {
+        it->second->uploadedVersion = 0;
+    }
+    else if (location == _builtInUniforms[UNIFORM_P_MATRIX]
+             || location == _builtInUniforms[UNIFORM_MV_MATRIX]
+             || location == _builtInUniforms[UNIFORM_MVP_MATRIX]
+             || location == _builtInUniforms[UNIFORM_NORMAL_MATRIX])
+    {
+        _builtInMatricesValid = false;
+    }
+}
+
 GLint GLProgram::getUniformLocationForName(const char* name) const
 {
     CCASSERT(name != nullptr, "Invalid uniform name" );
@@ -928,8 +1045,47 @@ void GLProgram::setUniformsForBuiltins(const Mat4 &matrixMV)
 {
     const auto& matrixP = _director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
 
-    if (_flags.usesP)
-        setUniformLocationWithMatrix4fv(_builtInUniforms[UNIFORM_P_MATRIX], matrixP.m, 1);
+    // Most batches share the camera and model view of the previous batch drawn with this program.
+    // In that case every matrix below is already in the program, so skip the products and the uploads.
+    const bool matricesChanged = !_builtInMatricesValid
+        || memcmp(&_builtInMatrixMV, &matrixMV, sizeof(Mat4)) != 0
+        || memcmp(&_builtInMatrixP, &matrixP, sizeof(Mat4)) != 0;
+
+    if (!matricesChanged)
+    {
+        _director->getRenderer()->addSkippedUniformUploads(_flags.usesP + _flags.usesMV + _flags.usesMVP + _flags.usesNormal);
+    }
+    else
+    {
+        if (_flags.usesP)
+            setUniformLocationWithMatrix4fv(_builtInUniforms[UNIFORM_P_MATRIX], matrixP.m, 1);
+
+        if (_flags.usesMV)
+            setUniformLocationWithMatrix4fv(_builtInUniforms[UNIFORM_MV_MATRIX], matrixMV.m, 1);
+
+        if (_flags.usesMVP)
+        {
+            Mat4 matrixMVP = matrixP * matrixMV;
+            setUniformLocationWithMatrix4fv(_builtInUniforms[UNIFORM_MVP_MATRIX], matrixMVP.m, 1);
+        }
+
+        if (_flags.usesNormal)
+        {
+            Mat4 mvInverse = matrixMV;
+            mvInverse.m[12] = mvInverse.m[13] = mvInverse.m[14] = 0.0f;
+            mvInverse.inverse();
+            mvInverse.transpose();
+            GLfloat normalMat[9];
+            normalMat[0] = mvInverse.m[0];normalMat[1] = mvInverse.m[1];normalMat[2] = mvInverse.m[2];
+            normalMat[3] = mvInverse.m[4];normalMat[4] = mvInverse.m[5];normalMat[5] = mvInverse.m[6];
+            normalMat[6] = mvInverse.m[8];normalMat[7] = mvInverse.m[9];normalMat[8] = mvInverse.m[10];
+            setUniformLocationWithMatrix3fv(_builtInUniforms[UNIFORM_NORMAL_MATRIX], normalMat, 1);
+        }
+
+        _builtInMatrixP.set(matrixP);
+        _builtInMatrixMV.set(matrixMV);
+        _builtInMatricesValid = true;
+    }
 
     if (_flags.usesMultiViewP)
     {
@@ -941,15 +1097,6 @@ void GLProgram::setUniformsForBuiltins(const Mat4 &matrixMV)
         setUniformLocationWithMatrix4fv(_builtInUniforms[UNIFORM_MULTIVIEW_P_MATRIX], mats[0].m, 4);
     }
 
-    if (_flags.usesMV)
-        setUniformLocationWithMatrix4fv(_builtInUniforms[UNIFORM_MV_MATRIX], matrixMV.m, 1);
-
-    if (_flags.usesMVP)
-    {
-        Mat4 matrixMVP = matrixP * matrixMV;
-        setUniformLocationWithMatrix4fv(_builtInUniforms[UNIFORM_MVP_MATRIX], matrixMVP.m, 1);
-    }
-
     if (_flags.usesMultiViewMVP)
     {
         Mat4 mats[4];
@@ -960,19 +1107,6 @@ void GLProgram::setUniformsForBuiltins(const Mat4 &matrixMV)
         setUniformLocationWithMatrix4fv(_builtInUniforms[UNIFORM_MULTIVIEW_MVP_MATRIX], mats[0].m, 4);
     }
 
-    if (_flags.usesNormal)
-    {
-        Mat4 mvInverse = matrixMV;
-        mvInverse.m[12] = mvInverse.m[13] = mvInverse.m[14] = 0.0f;
-        mvInverse.inverse();
-        mvInverse.transpose();
-        GLfloat normalMat[9];
-        normalMat[0] = mvInverse.m[0];normalMat[1] = mvInverse.m[1];normalMat[2] = mvInverse.m[2];
-        normalMat[3] = mvInverse.m[4];normalMat[4] = mvInverse.m[5];normalMat[5] = mvInverse.m[6];
-        normalMat[6] = mvInverse.m[8];normalMat[7] = mvInverse.m[9];normalMat[8] = mvInverse.m[10];
-        setUniformLocationWithMatrix3fv(_builtInUniforms[UNIFORM_NORMAL_MATRIX], normalMat, 1);
-    }
-
     if (_flags.usesTime) {
         // This doesn't give the most accurate global time value.
         // Cocos2D doesn't store a high precision time value, so this will have to do.
@@ -1024,6 +1158,12 @@ inline void GLProgram::clearHashUniforms()
     }
 
     _hashForUniforms.clear();
+
+    for (auto& uniform : _userUniforms)
+    {
+        uniform.second.uploadedVersion = 0;
+    }
+    _builtInMatricesValid = false;
 }
 
 NS_CC_END
@@ -49,6 +49,7 @@ NS_CC_BEGIN
 
 class GLProgram;
 class Director;
+class Data;
 //FIXME: these two typedefs would be deprecated or removed in version 4.0.
 typedef void (*GLInfoFunction)(GLuint program, GLenum pname, GLint* params);
 typedef void (*GLLogFunction) (GLuint program, GLsizei bufsize, GLsizei* length, GLchar* infolog);
@@ -76,6 +77,8 @@ struct Uniform
     GLenum type;
     /**String of the uniform name.*/
     std::string name;
+    /**Version of the UniformValue last uploaded to this location, 0 if unknown.*/
+    uint64_t uploadedVersion;
 };
 
 /** GLProgram
@@ -407,6 +410,17 @@ public:
      @}
      */
 
+    /** Initializes the GLProgram with a binary previously returned by getProgramBinary().
+     It returns false when program binaries are not supported or the driver rejects the binary
+     (eg: after a driver update). In that case the program must be initialized from source.
+     */
+    bool initWithProgramBinary(GLenum binaryFormat, const Data& binary);
+
+    /** Retrieves the driver specific binary of the linked program.
+     Returns false if program binaries are not supported or the program is not linked.
+     */
+    bool getProgramBinary(GLenum* binaryFormat, Data* binary) const;
+
     /**@{ Get the uniform or vertex attribute by string name in shader, return null if it does not exist.*/
     Uniform* getUniform(const std::string& name);
     VertexAttrib* getVertexAttrib(const std::string& name);
@@ -570,6 +584,8 @@ protected:
     void clearShader();
 
     void clearHashUniforms();
+    /**Forget the uniform values shadowed for a location after it was changed outside of a versioned upload.*/
+    void invalidateUniformVersion(GLint location);
 
     /**OpenGL handle for program.*/
     GLuint            _program;
@@ -588,6 +604,13 @@ protected:
     std::unordered_map<std::string, VertexAttrib> _vertexAttribs;
     /**Hash value of uniforms for quick access.*/
     std::unordered_map<GLint, std::pair<GLvoid*, unsigned int>> _hashForUniforms;
+    /**User defined Uniforms by location, used to invalidate their uploaded version.*/
+    std::unordered_map<GLint, Uniform*> _userUniformsByLocation;
+    /**Projection and model view matrices last sent by setUniformsForBuiltins().*/
+    Mat4 _builtInMatrixP;
+    Mat4 _builtInMatrixMV;
+    /**Whether _builtInMatrixP and _builtInMatrixMV match the values in the program.*/
+    bool _builtInMatricesValid;
     //cached director pointer for calling
     Director* _director;
 
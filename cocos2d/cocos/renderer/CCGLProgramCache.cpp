@@ -35,7 +35,11 @@ THE SOFTWARE.
 #include "base/CCEventListenerCustom.h"
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
+#include "base/CCData.h"
+#include "base/ccUTF8.h"
 #include "platform/CCDataManager.h"
+#include "platform/CCFileUtils.h"
+#include "xxhash.h"
 
 NS_CC_BEGIN
 
@@ -111,8 +115,23 @@ void GLProgramCache::purgeSharedShaderCache()
     GLProgramCache::destroyInstance();
 }
 
+#if CC_ENABLE_GLPROGRAM_BINARY_CACHE
+// header written in front of every cached program binary
+struct GLProgramBinaryHeader
+{
+    uint32_t magic;
+    uint32_t driverHash;
+    uint32_t sourceHash;
+    uint32_t binaryFormat;
+};
+
+static const uint32_t GLPROGRAM_BINARY_MAGIC = 0x43434250; // 'CCBP'
+#endif
+
 GLProgramCache::GLProgramCache()
 : _programs()
+, _defaultProgramTypes()
+, _driverHash(0)
 {
 
 }
@@ -130,6 +149,9 @@ bool GLProgramCache::init()
 {
 #if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
     DataManager::onShaderLoaderBegin();
+#endif
+#if CC_ENABLE_GLPROGRAM_BINARY_CACHE
+    initProgramBinaryCache();
 #endif
     loadDefaultGLPrograms();
     
@@ -146,522 +168,367 @@ bool GLProgramCache::init()
 
 void GLProgramCache::loadDefaultGLPrograms()
 {
-    // Position Texture Color shader
-    GLProgram *p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR, p);
-
-    // Position Texture Color without MVP shader
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor_noMVP);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, p);
-
-    // Position Texture Color alpha test
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTest);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST, p);
-
-    // Position Texture Color alpha test
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTestNoMV);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV, p);
-    //
-    // Position, Color shader
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionColor);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_COLOR, p);
-
-    // Position, Color, PointSize shader
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionColorTextureAsPointsize);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_COLOR_TEXASPOINTSIZE, p);
-
-    //
-    // Position, Color shader no MVP
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionColor_noMVP);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_COLOR_NO_MVP, p);
-
-    //
-    // Position Texture shader
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_TEXTURE, p);
-
-    //
-    // Position, Texture attribs, 1 Color as uniform shader
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture_uColor);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR, p);
-
-    //
-    // Position Texture A8 Color shader
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureA8Color);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR, p);
-
-    //
-    // Position and 1 color passed as a uniform (to simulate glColor4ub )
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_Position_uColor);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_U_COLOR, p);
-
-    //
-    // Position, Length(TexCoords, Color (used by Draw Node basically )
-    //
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_PositionLengthTextureColor);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldNormal);
-    _programs.emplace(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldGlow);
-    _programs.emplace(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_GLOW, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_UIGrayScale);
-    _programs.emplace(GLProgram::SHADER_NAME_POSITION_GRAYSCALE, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelNormal);
-    _programs.emplace(GLProgram::SHADER_NAME_LABEL_NORMAL, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LabelOutline);
-    _programs.emplace(GLProgram::SHADER_NAME_LABEL_OUTLINE, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DPosition);
-    _programs.emplace(GLProgram::SHADER_3D_POSITION, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DPositionTex);
-    _programs.emplace(GLProgram::SHADER_3D_POSITION_TEXTURE, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionTex);
-    _programs.emplace(GLProgram::SHADER_3D_SKINPOSITION_TEXTURE, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormal);
-    _programs.emplace(GLProgram::SHADER_3D_POSITION_NORMAL, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormalTex);
-    _programs.emplace(GLProgram::SHADER_3D_POSITION_NORMAL_TEXTURE, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionNormalTex);
-    _programs.emplace(GLProgram::SHADER_3D_SKINPOSITION_NORMAL_TEXTURE, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DPositionBumpedNormalTex);
-    _programs.emplace(GLProgram::SHADER_3D_POSITION_BUMPEDNORMAL_TEXTURE, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionBumpedNormalTex);
-    _programs.emplace(GLProgram::SHADER_3D_SKINPOSITION_BUMPEDNORMAL_TEXTURE, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DParticleColor);
-    _programs.emplace(GLProgram::SHADER_3D_PARTICLE_COLOR, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DParticleTex);
-    _programs.emplace(GLProgram::SHADER_3D_PARTICLE_TEXTURE, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DSkyBox);
-    _programs.emplace(GLProgram::SHADER_3D_SKYBOX, p);
-
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_3DTerrain);
-    _programs.emplace(GLProgram::SHADER_3D_TERRAIN, p);
-    
-    p = new (std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_CameraClear);
-    _programs.emplace(GLProgram::SHADER_CAMERA_CLEAR, p);
-
-    /// ETC1 ALPHA supports.
-    p = new(std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureColor);
-    _programs.emplace(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR, p);
-
-    p = new(std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureColor_noMVP);
-    _programs.emplace(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR_NO_MVP, p);
-
-    /// ETC1 Gray supports.
-    p = new(std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureGray);
-    _programs.emplace(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY, p);
-
-    p = new(std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureGray_noMVP);
-    _programs.emplace(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY_NO_MVP, p);
-    
-    p = new(std::nothrow) GLProgram();
-    loadDefaultGLProgram(p, kShaderType_LayerRadialGradient);
-    _programs.emplace(GLProgram::SHADER_LAYER_RADIAL_GRADIENT, p);
+    static const struct {
+        const char* key;
+        int type;
+    } defaultPrograms[] =
+    {
+        {GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR, kShaderType_PositionTextureColor},
+        {GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP, kShaderType_PositionTextureColor_noMVP},
+        {GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST, kShaderType_PositionTextureColorAlphaTest},
+        {GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV, kShaderType_PositionTextureColorAlphaTestNoMV},
+        {GLProgram::SHADER_NAME_POSITION_COLOR, kShaderType_PositionColor},
+        {GLProgram::SHADER_NAME_POSITION_COLOR_TEXASPOINTSIZE, kShaderType_PositionColorTextureAsPointsize},
+        {GLProgram::SHADER_NAME_POSITION_COLOR_NO_MVP, kShaderType_PositionColor_noMVP},
+        {GLProgram::SHADER_NAME_POSITION_TEXTURE, kShaderType_PositionTexture},
+        {GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR, kShaderType_PositionTexture_uColor},
+        {GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR, kShaderType_PositionTextureA8Color},
+        {GLProgram::SHADER_NAME_POSITION_U_COLOR, kShaderType_Position_uColor},
+        {GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR, kShaderType_PositionLengthTextureColor},
+        {GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL, kShaderType_LabelDistanceFieldNormal},
+        {GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_GLOW, kShaderType_LabelDistanceFieldGlow},
+        {GLProgram::SHADER_NAME_POSITION_GRAYSCALE, kShaderType_UIGrayScale},
+        {GLProgram::SHADER_NAME_LABEL_NORMAL, kShaderType_LabelNormal},
+        {GLProgram::SHADER_NAME_LABEL_OUTLINE, kShaderType_LabelOutline},
+        {GLProgram::SHADER_3D_POSITION, kShaderType_3DPosition},
+        {GLProgram::SHADER_3D_POSITION_TEXTURE, kShaderType_3DPositionTex},
+        {GLProgram::SHADER_3D_SKINPOSITION_TEXTURE, kShaderType_3DSkinPositionTex},
+        {GLProgram::SHADER_3D_POSITION_NORMAL, kShaderType_3DPositionNormal},
+        {GLProgram::SHADER_3D_POSITION_NORMAL_TEXTURE, kShaderType_3DPositionNormalTex},
+        {GLProgram::SHADER_3D_SKINPOSITION_NORMAL_TEXTURE, kShaderType_3DSkinPositionNormalTex},
+        {GLProgram::SHADER_3D_POSITION_BUMPEDNORMAL_TEXTURE, kShaderType_3DPositionBumpedNormalTex},
+        {GLProgram::SHADER_3D_SKINPOSITION_BUMPEDNORMAL_TEXTURE, kShaderType_3DSkinPositionBumpedNormalTex},
+        {GLProgram::SHADER_3D_PARTICLE_COLOR, kShaderType_3DParticleColor},
+        {GLProgram::SHADER_3D_PARTICLE_TEXTURE, kShaderType_3DParticleTex},
+        {GLProgram::SHADER_3D_SKYBOX, kShaderType_3DSkyBox},
+        {GLProgram::SHADER_3D_TERRAIN, kShaderType_3DTerrain},
+        {GLProgram::SHADER_CAMERA_CLEAR, kShaderType_CameraClear},
+        // ETC1 ALPHA supports.
+        {GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR, kShaderType_ETC1ASPositionTextureColor},
+        {GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR_NO_MVP, kShaderType_ETC1ASPositionTextureColor_noMVP},
+        // ETC1 Gray supports.
+        {GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY, kShaderType_ETC1ASPositionTextureGray},
+        {GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY_NO_MVP, kShaderType_ETC1ASPositionTextureGray_noMVP},
+        {GLProgram::SHADER_LAYER_RADIAL_GRADIENT, kShaderType_LayerRadialGradient},
+    };
+
+    for (const auto& program : defaultPrograms)
+    {
+        _defaultProgramTypes.emplace(program.key, program.type);
+#if !CC_ENABLE_LAZY_GLPROGRAM_LOADING
+        if (_programs.find(program.key) == _programs.end())
+        {
+            GLProgram *p = new (std::nothrow) GLProgram();
+            loadDefaultGLProgram(p, program.type);
+            _programs.emplace(program.key, p);
+        }
+#endif
+    }
 }
 
 void GLProgramCache::reloadDefaultGLPrograms()
 {
-    // reset all programs and reload them
-
-    // Position Texture Color shader
-    GLProgram *p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor);
-
-    // Position Texture Color without MVP shader
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_COLOR_NO_MVP);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColor_noMVP);
-
-    // Position Texture Color alpha test
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTest);
-
-    // Position Texture Color alpha test
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_ALPHA_TEST_NO_MV);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureColorAlphaTestNoMV);
-    //
-    // Position, Color shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionColor);
-
-    // Position, Color, PointSize shader
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_COLOR_TEXASPOINTSIZE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionColorTextureAsPointsize);
-
-    //
-    // Position, Color shader no MVP
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_COLOR_NO_MVP);
-    loadDefaultGLProgram(p, kShaderType_PositionColor_noMVP);
-
-    //
-    // Position Texture shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture);
-
-    //
-    // Position, Texture attribs, 1 Color as uniform shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_U_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTexture_uColor);
-
-    //
-    // Position Texture A8 Color shader
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE_A8_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionTextureA8Color);
-
-    //
-    // Position and 1 color passed as a uniform (to simulate glColor4ub )
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_U_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_Position_uColor);
-
-    //
-    // Position, Length(TexCoords, Color (used by Draw Node basically )
-    //
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_LENGTH_TEXTURE_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_PositionLengthTextureColor);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldNormal);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_GLOW);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelDistanceFieldGlow);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_POSITION_GRAYSCALE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_UIGrayScale);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_NORMAL);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelNormal);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_OUTLINE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_LabelOutline);
-
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPosition);
-
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormal);
-
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormalTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_NORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionNormalTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_BUMPEDNORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionBumpedNormalTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_BUMPEDNORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionBumpedNormalTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_PARTICLE_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DParticleTex);
-
-    p = getGLProgram(GLProgram::SHADER_3D_PARTICLE_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DParticleColor);
-
-    p = getGLProgram(GLProgram::SHADER_3D_SKYBOX);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkyBox);
-
-    p = getGLProgram(GLProgram::SHADER_3D_TERRAIN);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DTerrain);
-    
-    p = getGLProgram(GLProgram::SHADER_CAMERA_CLEAR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_CameraClear);
-
-    // ETC1 ALPHA supports.
-    p = getGLProgram(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureColor);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_COLOR_NO_MVP);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureColor_noMVP);
-
-    // ETC1 Gray supports.
-    p = getGLProgram(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureGray);
-
-    p = getGLProgram(GLProgram::SHADER_NAME_ETC1AS_POSITION_TEXTURE_GRAY_NO_MVP);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_ETC1ASPositionTextureGray_noMVP);
-    
-    p = getGLProgram(GLProgram::SHADER_LAYER_RADIAL_GRADIENT);
-    loadDefaultGLProgram(p, kShaderType_LayerRadialGradient);
-    _programs.emplace(GLProgram::SHADER_LAYER_RADIAL_GRADIENT, p);
+    // reset all programs and reload them.
+    // Programs that were never requested are still compiled lazily on first use.
+    for (const auto& program : _defaultProgramTypes)
+    {
+        reloadDefaultGLProgram(program.first, program.second);
+    }
 }
 
 void GLProgramCache::reloadDefaultGLProgramsRelativeToLights()
 {
-    GLProgram *p = getGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormal);
-    
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionNormalTex);
-    
-    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_NORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionNormalTex);
+    reloadDefaultGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL, kShaderType_3DPositionNormal);
+    reloadDefaultGLProgram(GLProgram::SHADER_3D_POSITION_NORMAL_TEXTURE, kShaderType_3DPositionNormalTex);
+    reloadDefaultGLProgram(GLProgram::SHADER_3D_SKINPOSITION_NORMAL_TEXTURE, kShaderType_3DSkinPositionNormalTex);
+    reloadDefaultGLProgram(GLProgram::SHADER_3D_POSITION_BUMPEDNORMAL_TEXTURE, kShaderType_3DPositionBumpedNormalTex);
+    reloadDefaultGLProgram(GLProgram::SHADER_3D_SKINPOSITION_BUMPEDNORMAL_TEXTURE, kShaderType_3DSkinPositionBumpedNormalTex);
+}
 
-    p = getGLProgram(GLProgram::SHADER_3D_POSITION_BUMPEDNORMAL_TEXTURE);
-    p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DPositionBumpedNormalTex);
+void GLProgramCache::reloadDefaultGLProgram(const std::string &key, int type)
+{
+    auto it = _programs.find(key);
+    if (it == _programs.end())
+        return;
 
-    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_BUMPEDNORMAL_TEXTURE);
+    GLProgram *p = it->second;
     p->reset();
-    loadDefaultGLProgram(p, kShaderType_3DSkinPositionBumpedNormalTex);
+    loadDefaultGLProgram(p, type);
 }
 
 void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
 {
+    const GLchar *vert = nullptr;
+    const GLchar *frag = nullptr;
+    std::string def;
+
     switch (type) {
         case kShaderType_PositionTextureColor:
-            p->initWithByteArrays(ccPositionTextureColor_vert, ccPositionTextureColor_frag);
+            vert = ccPositionTextureColor_vert; frag = ccPositionTextureColor_frag;
             break;
         case kShaderType_PositionTextureColor_noMVP:
-            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert, ccPositionTextureColor_noMVP_frag);
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccPositionTextureColor_noMVP_frag;
             break;
         case kShaderType_PositionTextureColorAlphaTest:
-            p->initWithByteArrays(ccPositionTextureColor_vert, ccPositionTextureColorAlphaTest_frag);
+            vert = ccPositionTextureColor_vert; frag = ccPositionTextureColorAlphaTest_frag;
             break;
         case kShaderType_PositionTextureColorAlphaTestNoMV:
-            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert, ccPositionTextureColorAlphaTest_frag);
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccPositionTextureColorAlphaTest_frag;
             break;
         case kShaderType_PositionColor:
-            p->initWithByteArrays(ccPositionColor_vert ,ccPositionColor_frag);
+            vert = ccPositionColor_vert; frag = ccPositionColor_frag;
             break;
         case kShaderType_PositionColorTextureAsPointsize:
-            p->initWithByteArrays(ccPositionColorTextureAsPointsize_vert ,ccPositionColor_frag);
+            vert = ccPositionColorTextureAsPointsize_vert; frag = ccPositionColor_frag;
             break;
         case kShaderType_PositionColor_noMVP:
-            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert ,ccPositionColor_frag);
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccPositionColor_frag;
             break;
         case kShaderType_PositionTexture:
-            p->initWithByteArrays(ccPositionTexture_vert ,ccPositionTexture_frag);
+            vert = ccPositionTexture_vert; frag = ccPositionTexture_frag;
             break;
         case kShaderType_PositionTexture_uColor:
-            p->initWithByteArrays(ccPositionTexture_uColor_vert, ccPositionTexture_uColor_frag);
+            vert = ccPositionTexture_uColor_vert; frag = ccPositionTexture_uColor_frag;
             break;
         case kShaderType_PositionTextureA8Color:
-            p->initWithByteArrays(ccPositionTextureA8Color_vert, ccPositionTextureA8Color_frag);
+            vert = ccPositionTextureA8Color_vert; frag = ccPositionTextureA8Color_frag;
             break;
         case kShaderType_Position_uColor:
-            p->initWithByteArrays(ccPosition_uColor_vert, ccPosition_uColor_frag);
-            p->bindAttribLocation("aVertex", GLProgram::VERTEX_ATTRIB_POSITION);
+            vert = ccPosition_uColor_vert; frag = ccPosition_uColor_frag;
             break;
         case kShaderType_PositionLengthTextureColor:
-            p->initWithByteArrays(ccPositionColorLengthTexture_vert, ccPositionColorLengthTexture_frag);
+            vert = ccPositionColorLengthTexture_vert; frag = ccPositionColorLengthTexture_frag;
             break;
         case kShaderType_LabelDistanceFieldNormal:
-            p->initWithByteArrays(ccLabel_vert, ccLabelDistanceFieldNormal_frag);
+            vert = ccLabel_vert; frag = ccLabelDistanceFieldNormal_frag;
             break;
         case kShaderType_LabelDistanceFieldGlow:
-            p->initWithByteArrays(ccLabel_vert, ccLabelDistanceFieldGlow_frag);
+            vert = ccLabel_vert; frag = ccLabelDistanceFieldGlow_frag;
             break;
         case kShaderType_UIGrayScale:
-            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert,
-                                  ccPositionTexture_GrayScale_frag);
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccPositionTexture_GrayScale_frag;
             break;
         case kShaderType_LabelNormal:
-            p->initWithByteArrays(ccLabel_vert, ccLabelNormal_frag);
+            vert = ccLabel_vert; frag = ccLabelNormal_frag;
             break;
         case kShaderType_LabelOutline:
-            p->initWithByteArrays(ccLabel_vert, ccLabelOutline_frag);
+            vert = ccLabel_vert; frag = ccLabelOutline_frag;
             break;
         case kShaderType_3DPosition:
-            p->initWithByteArrays(cc3D_PositionTex_vert, cc3D_Color_frag);
+            vert = cc3D_PositionTex_vert; frag = cc3D_Color_frag;
             break;
         case kShaderType_3DPositionTex:
-            p->initWithByteArrays(cc3D_PositionTex_vert, cc3D_ColorTex_frag);
+            vert = cc3D_PositionTex_vert; frag = cc3D_ColorTex_frag;
             break;
         case kShaderType_3DSkinPositionTex:
-            p->initWithByteArrays(cc3D_SkinPositionTex_vert, cc3D_ColorTex_frag);
+            vert = cc3D_SkinPositionTex_vert; frag = cc3D_ColorTex_frag;
             break;
         case kShaderType_3DPositionNormal:
-            {
-                std::string def = getShaderMacrosForLight();
-                p->initWithByteArrays((def + std::string(cc3D_PositionNormalTex_vert)).c_str(), (def + std::string(cc3D_ColorNormal_frag)).c_str());
-            }
+            def = getShaderMacrosForLight();
+            vert = cc3D_PositionNormalTex_vert; frag = cc3D_ColorNormal_frag;
             break;
         case kShaderType_3DPositionNormalTex:
-            {
-                std::string def = getShaderMacrosForLight();
-                p->initWithByteArrays((def + std::string(cc3D_PositionNormalTex_vert)).c_str(), (def + std::string(cc3D_ColorNormalTex_frag)).c_str());
-            }
+            def = getShaderMacrosForLight();
+            vert = cc3D_PositionNormalTex_vert; frag = cc3D_ColorNormalTex_frag;
             break;
         case kShaderType_3DSkinPositionNormalTex:
-            {
-                std::string def = getShaderMacrosForLight();
-                p->initWithByteArrays((def + std::string(cc3D_SkinPositionNormalTex_vert)).c_str(), (def + std::string(cc3D_ColorNormalTex_frag)).c_str());
-            }
+            def = getShaderMacrosForLight();
+            vert = cc3D_SkinPositionNormalTex_vert; frag = cc3D_ColorNormalTex_frag;
             break;
         case kShaderType_3DPositionBumpedNormalTex:
-            {
-                std::string def = getShaderMacrosForLight();
-                std::string normalMapDef = "\n#define USE_NORMAL_MAPPING 1 \n";
-                p->initWithByteArrays((def + normalMapDef + std::string(cc3D_PositionNormalTex_vert)).c_str(), (def + normalMapDef + std::string(cc3D_ColorNormalTex_frag)).c_str());
-            }
+            def = getShaderMacrosForLight() + "\n#define USE_NORMAL_MAPPING 1 \n";
+            vert = cc3D_PositionNormalTex_vert; frag = cc3D_ColorNormalTex_frag;
             break;
         case kShaderType_3DSkinPositionBumpedNormalTex:
-            {
-                std::string def = getShaderMacrosForLight();
-                std::string normalMapDef = "\n#define USE_NORMAL_MAPPING 1 \n";
-                p->initWithByteArrays((def + normalMapDef + std::string(cc3D_SkinPositionNormalTex_vert)).c_str(), (def + normalMapDef + std::string(cc3D_ColorNormalTex_frag)).c_str());
-            }
+            def = getShaderMacrosForLight() + "\n#define USE_NORMAL_MAPPING 1 \n";
+            vert = cc3D_SkinPositionNormalTex_vert; frag = cc3D_ColorNormalTex_frag;
             break;
         case kShaderType_3DParticleTex:
-           {
-                p->initWithByteArrays(cc3D_Particle_vert, cc3D_Particle_tex_frag);
-           }
+            vert = cc3D_Particle_vert; frag = cc3D_Particle_tex_frag;
             break;
         case kShaderType_3DParticleColor:
-            p->initWithByteArrays(cc3D_Particle_vert, cc3D_Particle_color_frag);
+            vert = cc3D_Particle_vert; frag = cc3D_Particle_color_frag;
             break;
         case kShaderType_3DSkyBox:
-            p->initWithByteArrays(cc3D_Skybox_vert, cc3D_Skybox_frag);
+            vert = cc3D_Skybox_vert; frag = cc3D_Skybox_frag;
             break;
         case kShaderType_3DTerrain:
-            p->initWithByteArrays(cc3D_Terrain_vert, cc3D_Terrain_frag);
+            vert = cc3D_Terrain_vert; frag = cc3D_Terrain_frag;
             break;
         case kShaderType_CameraClear:
-            p->initWithByteArrays(ccCameraClearVert, ccCameraClearFrag);
+            vert = ccCameraClearVert; frag = ccCameraClearFrag;
             break;
             /// ETC1 ALPHA supports.
         case kShaderType_ETC1ASPositionTextureColor:
-            p->initWithByteArrays(ccPositionTextureColor_vert, ccETC1ASPositionTextureColor_frag);
+            vert = ccPositionTextureColor_vert; frag = ccETC1ASPositionTextureColor_frag;
             break;
         case kShaderType_ETC1ASPositionTextureColor_noMVP:
-            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert, ccETC1ASPositionTextureColor_frag);
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccETC1ASPositionTextureColor_frag;
             break;
             /// ETC1 GRAY supports.
         case kShaderType_ETC1ASPositionTextureGray:
-            p->initWithByteArrays(ccPositionTextureColor_vert, ccETC1ASPositionTextureGray_frag);
+            vert = ccPositionTextureColor_vert; frag = ccETC1ASPositionTextureGray_frag;
             break;
         case kShaderType_ETC1ASPositionTextureGray_noMVP:
-            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert, ccETC1ASPositionTextureGray_frag);
+            vert = ccPositionTextureColor_noMVP_vert; frag = ccETC1ASPositionTextureGray_frag;
             break;
         case kShaderType_LayerRadialGradient:
-            p->initWithByteArrays(ccPosition_vert, ccShader_LayerRadialGradient_frag);
+            vert = ccPosition_vert; frag = ccShader_LayerRadialGradient_frag;
             break;
         default:
             CCLOG("cocos2d: %s:%d, error shader type", __FUNCTION__, __LINE__);
             return;
     }
 
+    const std::string vertSource = def + vert;
+    const std::string fragSource = def + frag;
+
+#if CC_ENABLE_GLPROGRAM_BINARY_CACHE
+    const uint32_t sourceHash = XXH32(fragSource.c_str(), (int)fragSource.length(), XXH32(vertSource.c_str(), (int)vertSource.length(), 0));
+    if (loadProgramBinary(p, sourceHash))
+    {
+        p->updateUniforms();
+        CHECK_GL_ERROR_DEBUG();
+        return;
+    }
+#endif
+
+    p->initWithByteArrays(vertSource.c_str(), fragSource.c_str());
+    if (type == kShaderType_Position_uColor)
+    {
+        p->bindAttribLocation("aVertex", GLProgram::VERTEX_ATTRIB_POSITION);
+    }
+
     p->link();
     p->updateUniforms();
 
+#if CC_ENABLE_GLPROGRAM_BINARY_CACHE
+    saveProgramBinary(p, sourceHash);
+#endif
+
     CHECK_GL_ERROR_DEBUG();
 }
 
+#if CC_ENABLE_GLPROGRAM_BINARY_CACHE
+void GLProgramCache::initProgramBinaryCache()
+{
+    _programBinaryPath.clear();
+    if (!Configuration::getInstance()->supportsProgramBinary())
+        return;
+
+    // binaries are only valid for the driver that produced them
+    std::string driver = Configuration::getInstance()->getValue("cocos2d.x.version").asString();
+    const GLenum driverStrings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    for (auto name : driverStrings)
+    {
+        auto str = (const char*)glGetString(name);
+        if (str)
+            driver += str;
+    }
+    _driverHash = XXH32(driver.c_str(), (int)driver.length(), 0);
+
+    auto fileUtils = FileUtils::getInstance();
+    std::string path = fileUtils->getWritablePath() + "glprograms/";
+    if (fileUtils->isDirectoryExist(path) || fileUtils->createDirectory(path))
+    {
+        _programBinaryPath = path;
+    }
+}
+
+std::string GLProgramCache::getProgramBinaryFilename(uint32_t sourceHash) const
+{
+    return _programBinaryPath + StringUtils::format("%08x_%08x.bin", _driverHash, sourceHash);
+}
+
+bool GLProgramCache::loadProgramBinary(GLProgram *p, uint32_t sourceHash)
+{
+    if (_programBinaryPath.empty())
+        return false;
+
+    auto fileUtils = FileUtils::getInstance();
+    const std::string filename = getProgramBinaryFilename(sourceHash);
+    if (!fileUtils->isFileExist(filename))
+        return false;
+
+    Data data = fileUtils->getDataFromFile(filename);
+    GLProgramBinaryHeader header;
+    if (data.getSize() <= (ssize_t)sizeof(header))
+    {
+        fileUtils->removeFile(filename);
+        return false;
+    }
+
+    memcpy(&header, data.getBytes(), sizeof(header));
+    Data binary;
+    if (header.magic == GLPROGRAM_BINARY_MAGIC
+        && header.driverHash == _driverHash
+        && header.sourceHash == sourceHash)
+    {
+        binary.copy(data.getBytes() + sizeof(header), data.getSize() - sizeof(header));
+    }
+
+    if (binary.isNull() || !p->initWithProgramBinary(header.binaryFormat, binary))
+    {
+        CCLOG("cocos2d: program binary %s is stale, compiling from source", filename.c_str());
+        fileUtils->removeFile(filename);
+        return false;
+    }
+
+    return true;
+}
+
+void GLProgramCache::saveProgramBinary(GLProgram *p, uint32_t sourceHash)
+{
+    if (_programBinaryPath.empty() || p->getProgram() == 0)
+        return;
+
+    GLenum binaryFormat = 0;
+    Data binary;
+    if (!p->getProgramBinary(&binaryFormat, &binary))
+        return;
+
+    GLProgramBinaryHeader header;
+    header.magic = GLPROGRAM_BINARY_MAGIC;
+    header.driverHash = _driverHash;
+    header.sourceHash = sourceHash;
+    header.binaryFormat = binaryFormat;
+
+    const ssize_t size = sizeof(header) + binary.getSize();
+    unsigned char* bytes = (unsigned char*)malloc(size);
+    memcpy(bytes, &header, sizeof(header));
+    memcpy(bytes + sizeof(header), binary.getBytes(), binary.getSize());
+
+    Data data;
+    data.fastSet(bytes, size);
+    FileUtils::getInstance()->writeDataToFile(data, getProgramBinaryFilename(sourceHash));
+}
+#endif // CC_ENABLE_GLPROGRAM_BINARY_CACHE
+
 GLProgram* GLProgramCache::getGLProgram(const std::string &key)
 {
     auto it = _programs.find(key);
     if( it != _programs.end() )
         return it->second;
+
+#if CC_ENABLE_LAZY_GLPROGRAM_LOADING
+    // built-in programs are compiled the first time they are requested
+    auto typeIt = _defaultProgramTypes.find(key);
+    if (typeIt != _defaultProgramTypes.end())
+    {
+        GLProgram *p = new (std::nothrow) GLProgram();
+        loadDefaultGLProgram(p, typeIt->second);
+        _programs.emplace(key, p);
+        return p;
+    }
+#endif
     return nullptr;
 }
 
 void GLProgramCache::addGLProgram(GLProgram* program, const std::string &key)
 {
     // release old one
-    auto prev = getGLProgram(key);
+    auto it = _programs.find(key);
+    auto prev = it != _programs.end() ? it->second : nullptr;
     if( prev == program )
         return;
 
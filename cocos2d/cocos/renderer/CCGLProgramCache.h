@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include <unordered_map>
 
 #include "base/CCRef.h"
+#include "base/ccConfig.h"
 
 /**
  * @addtogroup renderer
@@ -74,7 +75,10 @@ public:
     /** @deprecated Use destroyInstance() instead */
     CC_DEPRECATED_ATTRIBUTE static void purgeSharedShaderCache();
 
-    /** loads the default shaders */
+    /** loads the default shaders.
+     When CC_ENABLE_LAZY_GLPROGRAM_LOADING is enabled they are only registered here,
+     and compiled the first time getGLProgram() is called with their key.
+     */
     void loadDefaultGLPrograms();
     CC_DEPRECATED_ATTRIBUTE void loadDefaultShaders() { loadDefaultGLPrograms(); }
 
@@ -82,7 +86,8 @@ public:
     void reloadDefaultGLPrograms();
     CC_DEPRECATED_ATTRIBUTE void reloadDefaultShaders() { reloadDefaultGLPrograms(); }
 
-    /** returns a GL program for a given key 
+    /** returns a GL program for a given key.
+     A built-in program that was not used yet is compiled (or restored from the program binary cache) first.
      */
     GLProgram * getGLProgram(const std::string &key);
     CC_DEPRECATED_ATTRIBUTE GLProgram * getProgram(const std::string &key) { return getGLProgram(key); }
@@ -102,6 +107,13 @@ private:
     */
     bool init();
     void loadDefaultGLProgram(GLProgram *program, int type);
+    void reloadDefaultGLProgram(const std::string &key, int type);
+#if CC_ENABLE_GLPROGRAM_BINARY_CACHE
+    void initProgramBinaryCache();
+    std::string getProgramBinaryFilename(uint32_t sourceHash) const;
+    bool loadProgramBinary(GLProgram *program, uint32_t sourceHash);
+    void saveProgramBinary(GLProgram *program, uint32_t sourceHash);
+#endif
     /**
     @}
     */
@@ -111,6 +123,12 @@ private:
 
     /**Predefined shaders.*/
     std::unordered_map<std::string, GLProgram*> _programs;
+    /**Shader types of the predefined shaders, compiled on first request when lazy loading is enabled.*/
+    std::unordered_map<std::string, int> _defaultProgramTypes;
+    /**Hash of the GL driver strings, cached program binaries are only valid for the same driver.*/
+    uint32_t _driverHash;
+    /**Directory of the program binary cache, empty if the cache is disabled or unsupported.*/
+    std::string _programBinaryPath;
 };
 
 NS_CC_END
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCTexture2D.h"
+#include "renderer/CCRenderer.h"
 #include "base/CCEventCustom.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
@@ -46,6 +47,10 @@ NS_CC_BEGIN
 // static vector with all the registered custom binding resolvers
 std::vector<GLProgramState::AutoBindingResolver*> GLProgramState::_customAutoBindingResolvers;
 
+// versions are unique among all the uniform values, so a Uniform that stores the version
+// it was last uploaded with can tell whether it already holds a given value.
+static uint64_t s_uniformValueVersion = 0;
+
 //
 //
 // UniformValue
@@ -56,6 +61,7 @@ UniformValue::UniformValue()
 : _uniform(nullptr)
 , _glprogram(nullptr)
 , _type(Type::VALUE)
+, _version(0)
 {
 }
 
@@ -63,6 +69,7 @@ UniformValue::UniformValue(Uniform *uniform, GLProgram* glprogram)
 : _uniform(uniform)
 , _glprogram(glprogram)
 , _type(Type::VALUE)
+, _version(0)
 {
 }
 
@@ -114,6 +121,18 @@ void UniformValue::apply()
     }
     else /* _type == VALUE */
     {
+        if (_version != 0 && _uniform->uploadedVersion == _version)
+        {
+            // the program already holds this value, only the texture binding may have changed
+            if (_uniform->type == GL_SAMPLER_2D)
+                GL::bindTexture2DN(_value.tex.textureUnit, _value.tex.textureId);
+            else if (_uniform->type == GL_SAMPLER_CUBE)
+                GL::bindTextureN(_value.tex.textureUnit, _value.tex.textureId, GL_TEXTURE_CUBE_MAP);
+
+            Director::getInstance()->getRenderer()->addSkippedUniformUploads(1);
+            return;
+        }
+
         switch (_uniform->type) {
             case GL_SAMPLER_2D:
                 _glprogram->setUniformLocationWith1i(_uniform->location, _value.tex.textureUnit);
@@ -153,9 +172,21 @@ void UniformValue::apply()
                 CCASSERT(false, "Invalid UniformValue");
                 break;
         }
+
+        _uniform->uploadedVersion = _version;
     }
 }
 
+void UniformValue::setValue(void* destination, const void* value, size_t bytes)
+{
+    if (_type != Type::VALUE || _version == 0 || memcmp(destination, value, bytes) != 0)
+    {
+        memcpy(destination, value, bytes);
+        _version = ++s_uniformValueVersion;
+    }
+    _type = Type::VALUE;
+}
+
 void UniformValue::setCallback(const std::function<void(GLProgram*, Uniform*)> &callback)
 {
     // delete previously set callback
@@ -169,6 +200,7 @@ void UniformValue::setCallback(const std::function<void(GLProgram*, Uniform*)> &
 	*_value.callback = callback;
 
     _type = Type::CALLBACK_FN;
+    _version = 0;
 }
 
 void UniformValue::setTexture(GLuint textureId, GLuint textureUnit)
@@ -178,6 +210,7 @@ void UniformValue::setTexture(GLuint textureId, GLuint textureUnit)
     _value.tex.textureUnit = textureUnit;
     _value.tex.texture = nullptr;
     _type = Type::VALUE;
+    _version = ++s_uniformValueVersion;
 }
 
 void UniformValue::setTexture(Texture2D* texture, GLuint textureUnit)
@@ -193,21 +226,20 @@ void UniformValue::setTexture(Texture2D* texture, GLuint textureUnit)
         _value.tex.textureId = texture->getName();
         _value.tex.textureUnit = textureUnit;
         _type = Type::VALUE;
+        _version = ++s_uniformValueVersion;
     }
 }
 
 void UniformValue::setInt(int value)
 {
     CCASSERT(_uniform->type == GL_INT, "Wrong type: expecting GL_INT");
-    _value.intValue = value;
-    _type = Type::VALUE;
+    setValue(&_value.intValue, &value, sizeof(_value.intValue));
 }
 
 void UniformValue::setFloat(float value)
 {
     CCASSERT(_uniform->type == GL_FLOAT, "Wrong type: expecting GL_FLOAT");
-    _value.floatValue = value;
-    _type = Type::VALUE;
+    setValue(&_value.floatValue, &value, sizeof(_value.floatValue));
 }
 
 void UniformValue::setFloatv(ssize_t size, const float* pointer)
@@ -216,13 +248,13 @@ void UniformValue::setFloatv(ssize_t size, const float* pointer)
     _value.floatv.pointer = (const float*)pointer;
     _value.floatv.size = (GLsizei)size;
     _type = Type::POINTER;
+    _version = 0;
 }
 
 void UniformValue::setVec2(const Vec2& value)
 {
     CCASSERT(_uniform->type == GL_FLOAT_VEC2, "Wrong type: expecting GL_FLOAT_VEC2");
-	memcpy(_value.v2Value, &value, sizeof(_value.v2Value));
-    _type = Type::VALUE;
+    setValue(_value.v2Value, &value, sizeof(_value.v2Value));
 }
 
 void UniformValue::setVec2v(ssize_t size, const Vec2* pointer)
@@ -231,14 +263,13 @@ void UniformValue::setVec2v(ssize_t size, const Vec2* pointer)
     _value.v2f.pointer = (const float*)pointer;
     _value.v2f.size = (GLsizei)size;
     _type = Type::POINTER;
+    _version = 0;
 }
 
 void UniformValue::setVec3(const Vec3& value)
 {
     CCASSERT(_uniform->type == GL_FLOAT_VEC3, "Wrong type: expecting GL_FLOAT_VEC3");
-	memcpy(_value.v3Value, &value, sizeof(_value.v3Value));
-    _type = Type::VALUE;
-
+    setValue(_value.v3Value, &value, sizeof(_value.v3Value));
 }
 
 void UniformValue::setVec3v(ssize_t size, const Vec3* pointer)
@@ -247,13 +278,13 @@ void UniformValue::setVec3v(ssize_t size, const Vec3* pointer)
     _value.v3f.pointer = (const float*)pointer;
     _value.v3f.size = (GLsizei)size;
     _type = Type::POINTER;
+    _version = 0;
 }
 
 void UniformValue::setVec4(const Vec4& value)
 {
     CCASSERT (_uniform->type == GL_FLOAT_VEC4, "Wrong type: expecting GL_FLOAT_VEC4");
-	memcpy(_value.v4Value, &value, sizeof(_value.v4Value));
-    _type = Type::VALUE;
+    setValue(_value.v4Value, &value, sizeof(_value.v4Value));
 }
 
 void UniformValue::setVec4v(ssize_t size, const Vec4* pointer)
@@ -262,13 +293,13 @@ void UniformValue::setVec4v(ssize_t size, const Vec4* pointer)
     _value.v4f.pointer = (const float*)pointer;
     _value.v4f.size = (GLsizei)size;
     _type = Type::POINTER;
+    _version = 0;
 }
 
 void UniformValue::setMat4(const Mat4& value)
 {
     CCASSERT(_uniform->type == GL_FLOAT_MAT4, "_uniform's type should be equal GL_FLOAT_MAT4.");
-	memcpy(_value.matrixValue, &value, sizeof(_value.matrixValue));
-    _type = Type::VALUE;
+    setValue(_value.matrixValue, &value, sizeof(_value.matrixValue));
 }
 
 UniformValue& UniformValue::operator=(const UniformValue& o)
@@ -278,6 +309,7 @@ UniformValue& UniformValue::operator=(const UniformValue& o)
         _uniform = o._uniform;
         _glprogram = o._glprogram;
         _type = o._type;
+        _version = o._version;
         _value = o._value;
 
         if (_uniform->type == GL_SAMPLER_2D)
@@ -122,6 +122,8 @@ public:
     UniformValue& operator=(const UniformValue& o);
 
 protected:
+    /** Gives the value a new version if it is different from the stored one, then stores it */
+    void setValue(void* destination, const void* value, size_t bytes);
 
     enum class Type {
         VALUE,
@@ -135,6 +137,8 @@ protected:
     GLProgram* _glprogram;
     /** What kind of type is the Uniform */
     Type _type;
+    /** Unique version of the value, 0 for pointers and callbacks whose content can't be tracked */
+    uint64_t _version;
 
     /**
      @name Uniform Value Uniform
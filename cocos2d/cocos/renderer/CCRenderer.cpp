@@ -42,6 +42,7 @@
 
 #include "base/CCConfiguration.h"
 #include "base/CCDirector.h"
+#include "base/CCFrameArena.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
@@ -109,12 +110,59 @@ ssize_t RenderQueue::size() const
     return result;
 }
 
+// Same result as std::stable_sort, which allocates its merge buffer on every call,
+// with the buffer taken from the frame arena: insertion sorted runs, then merged pairwise.
+static void stableSortCommands(std::vector<RenderCommand*>& commands, bool (*compare)(RenderCommand*, RenderCommand*))
+{
+    const size_t RUN_SIZE = 32;
+    const size_t count = commands.size();
+    RenderCommand** data = commands.data();
+
+    for (size_t begin = 0; begin < count; begin += RUN_SIZE)
+    {
+        const size_t end = std::min(begin + RUN_SIZE, count);
+        for (size_t i = begin + 1; i < end; ++i)
+        {
+            RenderCommand* command = data[i];
+            size_t j = i;
+            for (; j > begin && compare(command, data[j - 1]); --j)
+            {
+                data[j] = data[j - 1];
+            }
+            data[j] = command;
+        }
+    }
+
+    if (count <= RUN_SIZE)
+    {
+        return;
+    }
+
+    RenderCommand** from = data;
+    RenderCommand** to = Director::getInstance()->getFrameArena()->allocate<RenderCommand*>(count);
+    for (size_t width = RUN_SIZE; width < count; width *= 2)
+    {
+        for (size_t begin = 0; begin < count; begin += 2 * width)
+        {
+            const size_t middle = std::min(begin + width, count);
+            const size_t end = std::min(begin + 2 * width, count);
+            std::merge(from + begin, from + middle, from + middle, from + end, to + begin, compare);
+        }
+        std::swap(from, to);
+    }
+
+    if (from != data)
+    {
+        std::copy(from, from + count, data);
+    }
+}
+
 void RenderQueue::sort()
 {
     // Don't sort _queue0, it already comes sorted
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::TRANSPARENT_3D]), std::end(_commands[QUEUE_GROUP::TRANSPARENT_3D]), compare3DCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_NEG]), std::end(_commands[QUEUE_GROUP::GLOBALZ_NEG]), compareRenderCommand);
-    std::stable_sort(std::begin(_commands[QUEUE_GROUP::GLOBALZ_POS]), std::end(_commands[QUEUE_GROUP::GLOBALZ_POS]), compareRenderCommand);
+    stableSortCommands(_commands[QUEUE_GROUP::TRANSPARENT_3D], compare3DCommand);
+    stableSortCommands(_commands[QUEUE_GROUP::GLOBALZ_NEG], compareRenderCommand);
+    stableSortCommands(_commands[QUEUE_GROUP::GLOBALZ_POS], compareRenderCommand);
 }
 
 RenderCommand* RenderQueue::operator[](ssize_t index) const
@@ -198,12 +246,18 @@ static const int DEFAULT_RENDER_QUEUE = 0;
 // constructors, destructor, init
 //
 Renderer::Renderer()
-:_lastBatchedMeshCommand(nullptr)
+:_scissorOuterEnabled(false)
+,_readbackBufferCount(0)
+,_lastBatchedMeshCommand(nullptr)
 ,_triBatchesToDrawCapacity(-1)
 ,_triBatchesToDraw(nullptr)
 ,_filledVertex(0)
 ,_filledIndex(0)
 ,_glViewAssigned(false)
+,_drawnBatches(0)
+,_drawnVertices(0)
+,_uploadedUniforms(0)
+,_skippedUniformUploads(0)
 ,_isRendering(false)
 ,_isDepthTestFor2D(false)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -230,6 +284,8 @@ Renderer::~Renderer()
 {
     _renderGroups.clear();
     _groupCommandManager->release();
+
+    releaseReadbackBuffers(false);
     
     glDeleteBuffers(2, _buffersVBO);
 
@@ -251,6 +307,7 @@ void Renderer::initGLView()
     _cacheTextureListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, [this](EventCustom* event){
         /** listen the event that renderer was recreated on Android/WP8 */
         this->setupBuffer();
+        this->releaseReadbackBuffers(true);
     });
     
     Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_cacheTextureListener, -1);
@@ -637,6 +694,9 @@ void Renderer::render()
     //TODO: setup camera or MVP
     _isRendering = true;
     
+    if (!_pendingReadbacks.empty())
+        processPendingReadbacks(false);
+
     if (_glViewAssigned)
     {
         //Process render commands
@@ -928,6 +988,208 @@ bool Renderer::checkVisibility(const Mat4 &transform, const Size &size)
     return ret;
 }
 
+bool Renderer::getScissorRect(const Mat4& transform, const Rect& rect, Rect* scissorRect)
+{
+    auto director = Director::getInstance();
+    auto scene = director->getRunningScene();
+    auto camera = Camera::getVisitingCamera();
+
+    // same restriction as checkVisibility(): other cameras may render to a viewport or a framebuffer
+    if (!scene || scene->_defaultCamera != camera)
+        return false;
+
+    // a RenderTexture being drawn replaces the projection of the camera
+    const Mat4& projection = director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+    if (memcmp(projection.m, camera->getViewProjectionMatrix().m, sizeof(projection.m)) != 0)
+        return false;
+
+    return camera->projectRectGL(transform, rect, scissorRect);
+}
+
+void Renderer::pushScissorRect(const Rect& rect)
+{
+    // batched geometry queued so far was meant for the old scissor box
+    flush();
+
+    auto glview = Director::getInstance()->getOpenGLView();
+    Rect current;
+    bool clipped = true;
+    if (_scissorStack.empty())
+    {
+        // someone outside the stack (e.g. a Layout in SCISSOR mode) may have set a scissor box already
+        _scissorOuterEnabled = glview->isScissorEnabled();
+        if (_scissorOuterEnabled)
+            _scissorOuterRect = glview->getScissorRect();
+        else
+            glEnable(GL_SCISSOR_TEST);
+        current = _scissorOuterRect;
+        clipped = _scissorOuterEnabled;
+    }
+    else
+    {
+        current = _scissorStack.back();
+    }
+
+    Rect clip = rect;
+    if (clipped)
+    {
+        float minX = std::max(rect.getMinX(), current.getMinX());
+        float minY = std::max(rect.getMinY(), current.getMinY());
+        float maxX = std::min(rect.getMaxX(), current.getMaxX());
+        float maxY = std::min(rect.getMaxY(), current.getMaxY());
+        clip.setRect(minX, minY, std::max(0.0f, maxX - minX), std::max(0.0f, maxY - minY));
+    }
+
+    _scissorStack.push_back(clip);
+    if (!clipped || !clip.equals(current))
+        glview->setScissorInPoints(clip.origin.x, clip.origin.y, clip.size.width, clip.size.height);
+}
+
+void Renderer::popScissorRect()
+{
+    CCASSERT(!_scissorStack.empty(), "popScissorRect() without a matching pushScissorRect()");
+    if (_scissorStack.empty())
+        return;
+
+    flush();
+
+    auto glview = Director::getInstance()->getOpenGLView();
+    Rect popped = _scissorStack.back();
+    _scissorStack.pop_back();
+    if (!_scissorStack.empty())
+    {
+        const Rect& previous = _scissorStack.back();
+        if (!previous.equals(popped))
+            glview->setScissorInPoints(previous.origin.x, previous.origin.y, previous.size.width, previous.size.height);
+    }
+    else if (_scissorOuterEnabled)
+    {
+        if (!_scissorOuterRect.equals(popped))
+            glview->setScissorInPoints(_scissorOuterRect.origin.x, _scissorOuterRect.origin.y, _scissorOuterRect.size.width, _scissorOuterRect.size.height);
+    }
+    else
+    {
+        glDisable(GL_SCISSOR_TEST);
+    }
+}
+
+void Renderer::readPixelsAsync(int x, int y, int width, int height, const ReadPixelsCallback& callback)
+{
+    // the pixels must include everything queued before this call
+    flush();
+
+    PendingReadback readback;
+    readback.buffer = 0;
+    readback.frame = Director::getInstance()->getTotalFrames();
+    readback.width = width;
+    readback.height = height;
+    readback.callback = callback;
+
+    ssize_t size = (ssize_t)width * height * 4;
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+#ifdef GL_PIXEL_PACK_BUFFER
+    if (Configuration::getInstance()->supportsPixelBufferObject())
+    {
+        if (_freeReadbackBuffers.empty() && _readbackBufferCount >= CC_PIXEL_READBACK_BUFFER_COUNT)
+        {
+            // every buffer is in flight: map the oldest read now
+            processPendingReadbacks(true);
+        }
+        if (_freeReadbackBuffers.empty())
+        {
+            GLuint buffer = 0;
+            glGenBuffers(1, &buffer);
+            _freeReadbackBuffers.push_back(buffer);
+            ++_readbackBufferCount;
+        }
+        readback.buffer = _freeReadbackBuffers.back();
+        _freeReadbackBuffers.pop_back();
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        CHECK_GL_ERROR_DEBUG();
+
+        _pendingReadbacks.push_back(std::move(readback));
+        return;
+    }
+#endif
+
+    unsigned char* pixels = (unsigned char*)malloc(size);
+    if (pixels)
+    {
+        glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        readback.pixels.fastSet(pixels, size);
+    }
+    _pendingReadbacks.push_back(std::move(readback));
+}
+
+void Renderer::processPendingReadbacks(bool force)
+{
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+
+    // pending reads complete in issue order; callbacks run after the list is updated
+    // because they may issue new reads
+    std::vector<PendingReadback> completed;
+    bool freedBuffer = false;
+    auto it = _pendingReadbacks.begin();
+    for (; it != _pendingReadbacks.end(); ++it)
+    {
+        // when forced, map at least one buffer even if the GPU may still be writing it
+        if (it->buffer != 0 && frame < it->frame + 2 && !(force && !freedBuffer))
+            break;
+
+#ifdef GL_PIXEL_PACK_BUFFER
+        if (it->buffer != 0)
+        {
+            ssize_t size = (ssize_t)it->width * it->height * 4;
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, it->buffer);
+#ifdef CC_PLATFORM_PC
+            void* mapped = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+#else
+            void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+#endif
+            if (mapped)
+            {
+                it->pixels.copy((const unsigned char*)mapped, size);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            _freeReadbackBuffers.push_back(it->buffer);
+            freedBuffer = true;
+        }
+#endif
+        completed.push_back(std::move(*it));
+    }
+    _pendingReadbacks.erase(_pendingReadbacks.begin(), it);
+
+    for (auto& readback : completed)
+    {
+        if (readback.callback)
+            readback.callback(readback.pixels, readback.width, readback.height);
+    }
+}
+
+void Renderer::releaseReadbackBuffers(bool contextLost)
+{
+    for (auto& readback : _pendingReadbacks)
+    {
+        if (readback.buffer != 0)
+        {
+            // the read is reported as failed by the next render()
+            if (!contextLost)
+                glDeleteBuffers(1, &readback.buffer);
+            readback.buffer = 0;
+            readback.pixels.clear();
+        }
+    }
+    if (!contextLost && !_freeReadbackBuffers.empty())
+        glDeleteBuffers((GLsizei)_freeReadbackBuffers.size(), _freeReadbackBuffers.data());
+    _freeReadbackBuffers.clear();
+    _readbackBufferCount = 0;
+}
 
 void Renderer::setClearColor(const Color4F &clearColor)
 {
@@ -29,8 +29,10 @@
 
 #include <vector>
 #include <stack>
+#include <functional>
 
 #include "platform/CCPlatformMacros.h"
+#include "base/CCData.h"
 #include "renderer/CCRenderCommand.h"
 #include "renderer/CCGLProgram.h"
 #include "platform/CCGL.h"
@@ -193,8 +195,16 @@ public:
     ssize_t getDrawnVertices() const { return _drawnVertices; }
     /* RenderCommands (except) TrianglesCommand should update this value */
     void addDrawnVertices(ssize_t number) { _drawnVertices += number; };
+    /* returns the number of glUniform calls issued in the last frame */
+    ssize_t getUploadedUniforms() const { return _uploadedUniforms; }
+    /* GLProgram updates this value when a uniform value is sent to GL */
+    void addUploadedUniforms(ssize_t number) { _uploadedUniforms += number; }
+    /* returns the number of glUniform calls skipped in the last frame because the program already had the value */
+    ssize_t getSkippedUniformUploads() const { return _skippedUniformUploads; }
+    /* GLProgram updates this value when a redundant uniform upload is skipped */
+    void addSkippedUniformUploads(ssize_t number) { _skippedUniformUploads += number; }
     /* clear draw stats */
-    void clearDrawStats() { _drawnBatches = _drawnVertices = 0; }
+    void clearDrawStats() { _drawnBatches = _drawnVertices = _uploadedUniforms = _skippedUniformUploads = 0; }
 
     /**
      * Enable/Disable depth test
@@ -209,6 +219,34 @@ public:
     /** returns whether or not a rectangle is visible or not */
     bool checkVisibility(const Mat4& transform, const Size& size);
 
+    /**
+     * Returns whether a rectangle drawn with the given model-view transform stays axis-aligned on screen,
+     * in which case clipping to it can use the scissor test instead of the stencil buffer.
+     * Only the default camera rendering straight to the screen qualifies.
+     */
+    bool getScissorRect(const Mat4& transform, const Rect& rect, Rect* scissorRect);
+
+    /**
+     * Pushes a scissor rectangle, in GL-screen-space points, intersected with the scissor box that is currently active.
+     * Must be called while rendering (from a CustomCommand) and balanced with popScissorRect().
+     */
+    void pushScissorRect(const Rect& rect);
+    /** Restores the scissor state that was active before the matching pushScissorRect(). */
+    void popScissorRect();
+
+    /** Receives the pixels of readPixelsAsync(): tightly packed RGBA8888 rows, bottom row first.
+     * The data is empty if the read failed, e.g. because the GL context was lost.
+     */
+    typedef std::function<void(Data& pixels, int width, int height)> ReadPixelsCallback;
+
+    /**
+     * Reads a region of the currently bound framebuffer without waiting for the GPU.
+     * When pixel buffer objects are supported the read goes into a ring of CC_PIXEL_READBACK_BUFFER_COUNT
+     * buffers that are mapped two frames later; otherwise the pixels are read immediately.
+     * In both cases the callback is invoked on the cocos thread from a later render().
+     */
+    void readPixelsAsync(int x, int y, int width, int height, const ReadPixelsCallback& callback);
+
 protected:
 
     //Setup VBO or VAO based on OpenGL extensions
@@ -232,11 +270,35 @@ protected:
 
     void fillVerticesAndIndices(const TrianglesCommand* cmd);
 
+    // completes the reads issued at least two frames ago; when force is true it also maps
+    // the oldest pending buffer even if it is more recent, so that one buffer is freed
+    void processPendingReadbacks(bool force);
+    // forgets the pixel buffer objects after the GL context was lost, or deletes them
+    void releaseReadbackBuffers(bool contextLost);
+
 
     /* clear color set outside be used in setGLDefaultValues() */
     Color4F _clearColor;
 
     std::stack<int> _commandGroupStack;
+
+    // nested scissor rectangles pushed by the clipping nodes, plus the GL state found under the first one
+    std::vector<Rect> _scissorStack;
+    Rect _scissorOuterRect;
+    bool _scissorOuterEnabled;
+
+    struct PendingReadback
+    {
+        GLuint buffer; // 0 when the pixels were read synchronously
+        unsigned int frame;
+        int width;
+        int height;
+        Data pixels;
+        ReadPixelsCallback callback;
+    };
+    std::vector<PendingReadback> _pendingReadbacks;
+    std::vector<GLuint> _freeReadbackBuffers;
+    int _readbackBufferCount;
     
     std::vector<RenderQueue> _renderGroups;
 
@@ -268,6 +330,8 @@ protected:
     // stats
     ssize_t _drawnBatches;
     ssize_t _drawnVertices;
+    ssize_t _uploadedUniforms;
+    ssize_t _skippedUniformUploads;
     //the flag for checking whether renderer is rendering
     bool _isRendering;
     
@@ -261,6 +261,13 @@ void Layout::stencilClippingVisit(Renderer *renderer, const Mat4& parentTransfor
     CCASSERT(nullptr != director, "Director is null when setting matrix stack");
     director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
     director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
+    // the stencil is always a rectangle of the content size, so clip with the scissor box
+    // whenever it stays axis-aligned on screen
+    Rect scissorRect;
+    Mat4 stencilTransform = _modelViewTransform * _clippingStencil->getNodeToParentTransform();
+    bool useScissor = _clippingStencil->isVisible()
+                   && renderer->getScissorRect(stencilTransform, Rect(Vec2::ZERO, _contentSize), &scissorRect);
+
     //Add group command
 
     _groupCommand.init(_globalZOrder);
@@ -268,15 +275,24 @@ void Layout::stencilClippingVisit(Renderer *renderer, const Mat4& parentTransfor
     
     renderer->pushGroup(_groupCommand.getRenderQueueID());
     
-    _beforeVisitCmdStencil.init(_globalZOrder);
-    _beforeVisitCmdStencil.func = CC_CALLBACK_0(StencilStateManager::onBeforeVisit, _stencilStateManager);
-    renderer->addCommand(&_beforeVisitCmdStencil);
-    
-    _clippingStencil->visit(renderer, _modelViewTransform, flags);
-    
-    _afterDrawStencilCmd.init(_globalZOrder);
-    _afterDrawStencilCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterDrawStencil, _stencilStateManager);
-    renderer->addCommand(&_afterDrawStencilCmd);
+    if (useScissor)
+    {
+        _beforeVisitCmdStencil.init(_globalZOrder);
+        _beforeVisitCmdStencil.func = [renderer, scissorRect]() { renderer->pushScissorRect(scissorRect); };
+        renderer->addCommand(&_beforeVisitCmdStencil);
+    }
+    else
+    {
+        _beforeVisitCmdStencil.init(_globalZOrder);
+        _beforeVisitCmdStencil.func = CC_CALLBACK_0(StencilStateManager::onBeforeVisit, _stencilStateManager);
+        renderer->addCommand(&_beforeVisitCmdStencil);
+
+        _clippingStencil->visit(renderer, _modelViewTransform, flags);
+
+        _afterDrawStencilCmd.init(_globalZOrder);
+        _afterDrawStencilCmd.func = CC_CALLBACK_0(StencilStateManager::onAfterDrawStencil, _stencilStateManager);
+        renderer->addCommand(&_afterDrawStencilCmd);
+    }
     
     int i = 0;      // used by _children
     int j = 0;      // used by _protectedChildren
@@ -323,7 +339,10 @@ void Layout::stencilClippingVisit(Renderer *renderer, const Mat4& parentTransfor
 
     
     _afterVisitCmdStencil.init(_globalZOrder);
-    _afterVisitCmdStencil.func = CC_CALLBACK_0(StencilStateManager::onAfterVisit, _stencilStateManager);
+    if (useScissor)
+        _afterVisitCmdStencil.func = [renderer]() { renderer->popScissorRect(); };
+    else
+        _afterVisitCmdStencil.func = CC_CALLBACK_0(StencilStateManager::onAfterVisit, _stencilStateManager);
     renderer->addCommand(&_afterVisitCmdStencil);
     
     renderer->popGroup();
@@ -333,45 +352,14 @@ void Layout::stencilClippingVisit(Renderer *renderer, const Mat4& parentTransfor
     
 void Layout::onBeforeVisitScissor()
 {
-    auto glview = Director::getInstance()->getOpenGLView();
-    // apply scissor test
-    _scissorOldState = glview->isScissorEnabled();
-    if (false == _scissorOldState)
-    {
-        glEnable(GL_SCISSOR_TEST);
-    }
-
-    // apply scissor box
-    Rect clippingRect = getClippingRect();
-    _clippingOldRect = glview->getScissorRect();
-    if (false == _clippingOldRect.equals(clippingRect))
-    {
-        glview->setScissorInPoints(clippingRect.origin.x,
-                                   clippingRect.origin.y,
-                                   clippingRect.size.width,
-                                   clippingRect.size.height);
-    }
+    // the renderer keeps the previous scissor state and intersects with clipping ancestors
+    // that are not Layouts, e.g. a ClippingRectangleNode
+    Director::getInstance()->getRenderer()->pushScissorRect(getClippingRect());
 }
 
 void Layout::onAfterVisitScissor()
 {
-    if (_scissorOldState)
-    {
-        // revert scissor box
-        if (false == _clippingOldRect.equals(_clippingRect))
-        {
-            auto glview = Director::getInstance()->getOpenGLView();
-            glview->setScissorInPoints(_clippingOldRect.origin.x,
-                                       _clippingOldRect.origin.y,
-                                       _clippingOldRect.size.width,
-                                       _clippingOldRect.size.height);
-        }
-    }
-    else
-    {
-        // revert scissor test
-        glDisable(GL_SCISSOR_TEST);
-    }
+    Director::getInstance()->getRenderer()->popScissorRect();
 }
     
 void Layout::scissorClippingVisit(Renderer *renderer, const Mat4& parentTransform, uint32_t parentFlags)
@@ -628,8 +628,6 @@ protected:
     Type _layoutType;
     ClippingType _clippingType;
     DrawNode* _clippingStencil;
-    bool _scissorOldState;
-    Rect _clippingOldRect;
     Rect _clippingRect;
     Layout* _clippingParent;
     bool _clippingRectDirty;